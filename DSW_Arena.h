@@ -0,0 +1,126 @@
+// Runtime sized forecast storage for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// The DSW_minutely_t, DSW_hourly_t and DSW_daily_t array sizes are fixed when the sketch
+// is compiled (MAX_MINUTES etc in User_Setup.h). A DSW_arena is one block of memory from
+// which the forecast structures are allocated with sizes and data points chosen when the
+// sketch runs, so the same firmware can fetch a different number of hours or days on
+// each device. reset() releases everything at once ready for the next fetch:
+//
+//   DSW_arena arena(6000);                       // Allocate the block once
+//
+//   arena.reset();                               // Before each fetch
+//   DSW_current  *current = arena.create<DSW_current>();
+//   DSW_hourly_a *hourly  = arena.hourly(hours, DSW_HOURLY_time | DSW_HOURLY_temperature);
+//   DSW_daily_a  *daily   = arena.daily(days);
+//   dsw.getForecast(current, nullptr, hourly, daily, api_key, ...);
+//   Serial.println(hourly->temperature[3]);
+//
+// An allocation returns nullptr if the arena is too small, used() reports the bytes
+// taken. The values are accessed as for the structs, an array that was not selected is
+// a nullptr. Strings (the summaries) keep their text on the heap as usual.
+
+#ifndef DSW_Arena_h
+#define DSW_Arena_h
+
+#include <new>
+#include <type_traits>
+
+/***************************************************************************************
+** Description:   Runtime sized section structures, allocated by DSW_arena
+***************************************************************************************/
+// Each array data point is a pointer to "size" elements in the arena
+#define DSW_ARENA_SCALAR(S, s, m, k, kind)  DSW_SCALAR_##kind(m);
+#define DSW_ARENA_ARRAY(S, s, m, k, kind)   DSW_TYPE_##kind *m = nullptr;
+
+#define DSW_ARENA_SCALAR_BIND(S, s, m, k, kind) if (fields & DSW_##S##_##m) b.slot[DSW_FIELD_##s##_##m] = &m;
+#define DSW_ARENA_ARRAY_BIND(S, s, m, k, kind)  if (m) b.slot[DSW_FIELD_##s##_##m] = m;
+
+#define DSW_ARENA_STRUCT(S, s, name)                                                    \
+  typedef struct name {                                                                 \
+    DSW_##S##_SCALARS(DSW_ARENA_SCALAR, S, s)                                           \
+    DSW_##S##_ARRAYS(DSW_ARENA_ARRAY, S, s)                                             \
+    uint32_t fields = 0; /* Data points allocated */                                    \
+    uint16_t size = 0;   /* "data" array elements */                                    \
+    void dswBind(dsw_binding_t &b) {                                                    \
+      DSW_##S##_SCALARS(DSW_ARENA_SCALAR_BIND, S, s)                                    \
+      DSW_##S##_ARRAYS(DSW_ARENA_ARRAY_BIND, S, s)                                      \
+      b.fields[DSW_##S] = fields;                                                       \
+      b.size[DSW_##S] = size;                                                           \
+    }                                                                                   \
+  } name;
+
+DSW_ARENA_STRUCT(MINUTELY, minutely, DSW_minutely_a)
+DSW_ARENA_STRUCT(HOURLY, hourly, DSW_hourly_a)
+DSW_ARENA_STRUCT(DAILY, daily, DSW_daily_a)
+
+/***************************************************************************************
+** Description:   Bump allocator the forecast structures are created in
+***************************************************************************************/
+class DSW_arena {
+
+  public:
+    DSW_arena(void *buffer, size_t size);  // Use a block the sketch provides
+    DSW_arena(size_t size);                // Allocate the block from the heap once
+    ~DSW_arena();
+
+    DSW_arena(const DSW_arena &) = delete;
+    DSW_arena &operator=(const DSW_arena &) = delete;
+
+    // Destroy all the objects and make the whole block free again
+    void reset() { release(base); }
+
+    size_t used()     { return top - base; }
+    size_t capacity() { return end - base; }
+
+    // Section structures with n "data" array elements and the data points in mask
+    // fields, e.g. arena.hourly(12, DSW_HOURLY_time | DSW_HOURLY_temperature)
+    DSW_minutely_a *minutely(uint16_t n, uint32_t fields = DSW_MINUTELY_ALL);
+    DSW_hourly_a   *hourly(uint16_t n, uint32_t fields = DSW_HOURLY_ALL);
+    DSW_daily_a    *daily(uint16_t n, uint32_t fields = DSW_DAILY_ALL);
+
+    // Construct any object, e.g. arena.create<DSW_current>(), nullptr if no room
+    template <class T> T *create() {
+      return array<T>(1, T());
+    }
+
+    // Construct n copies of init, nullptr if no room
+    template <class T> T *array(uint16_t n, const T &init) {
+      uint8_t *mark = top;
+      if (!std::is_trivially_destructible<T>::value && !addCleanup(destroy<T>, n)) return nullptr;
+      T *p = (T *)alloc(n * sizeof(T), alignof(T));
+      if (!p) { release(mark); return nullptr; }
+      for (uint16_t i = 0; i < n; i++) new (p + i) T(init);
+      if (!std::is_trivially_destructible<T>::value) cleanup->object = p;
+      return p;
+    }
+
+  private:
+    // Objects needing a destructor call are listed so reset() can destroy them
+    struct dsw_cleanup_t {
+      void (*destroy)(void *p, uint16_t n);
+      void *object;
+      uint16_t count;
+      dsw_cleanup_t *next;
+    };
+
+    template <class T> static void destroy(void *p, uint16_t n) {
+      for (uint16_t i = 0; i < n; i++) ((T *)p)[i].~T();
+    }
+
+    void *alloc(size_t size, size_t align);
+    bool  addCleanup(void (*destroy)(void *, uint16_t), uint16_t n);
+    void  release(uint8_t *mark); // Destroy objects above mark and move top back to it
+
+    uint8_t       *base;
+    uint8_t       *top;
+    uint8_t       *end;
+    bool           owner;        // true if the block is freed by the destructor
+    dsw_cleanup_t *cleanup;      // Most recent first
+};
+
+#endif
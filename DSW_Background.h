@@ -0,0 +1,221 @@
+// Background forecast refresh for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// A DSW_background fetches the forecast on its own FreeRTOS task (ESP32 only) so the
+// sketch loop() never waits for it. It holds two sets of structs: the newest complete
+// forecast is read by the sketch while the other is filled by the next fetch, and the
+// two are swapped only when a fetch succeeds, so a half updated forecast is never seen:
+//
+//   #include <DSW_Background.h>
+//
+//   typedef DSW_background<DSW_current, DSW_none, DSW_hourly, DSW_daily> Weather;
+//   Weather weather;                              // Normally a global, it is large
+//
+//   weather.begin(api_key, latitude, longitude, units, language, 15 * 60);
+//   ...
+//   if (weather.generation() != shown) {          // A new forecast has arrived
+//     const Weather::forecast_t *f = weather.acquire();
+//     drawTemperature(f->current.temperature);
+//     shown = f->generation;
+//     weather.release(f);
+//   }
+//
+// A forecast from acquire() stays unchanged until release(), the task waits for it
+// before filling that set again, so hold it only while drawing. DSW_none excludes a
+// section. Each set has its own summary pool for compact structs (see DSW_Compact.h).
+//
+// The DS_Weather used by the task is weather.weather(), set its options (e.g.
+// setInflater()) before begin(). It belongs to the task until end(), its changes(),
+// aggregates and history are written by the task while the sketch runs. Use the
+// changes[] of an acquired forecast instead, they are saved before it is published. A
+// set is refilled over the forecast it held two generations back, so changes[] compares
+// with that one (all data points are reported changed after a failed fetch into it).
+//
+// Define DSW_STD_THREAD to build this with std::thread instead of FreeRTOS, e.g. to test
+// it on a PC.
+
+#ifndef DSW_Background_h
+#define DSW_Background_h
+
+#include "DarkSkyWeather.h"
+
+// Section type that is not fetched
+typedef decltype(nullptr) DSW_none;
+
+// A struct pointer for getForecast(), nullptr for DSW_none
+template <class T> T *dswSection(T &s) { return &s; }
+inline DSW_none dswSection(DSW_none &) { return nullptr; }
+
+// Count the "data" elements again when a set is refilled. The values are kept so the
+// parse can tell which changed, see DS_Weather::changes()
+template <class T> auto dswRecordsClear(T &s, int) -> decltype((void)(s.records = 0)) { s.records = 0; }
+template <class T> void dswRecordsClear(T &, long) { } // No count e.g. DSW_current, DSW_none
+template <class T> void dswSectionRestart(T &s) { dswRecordsClear(s, 0); }
+
+// Save the changes() of a set just filled. After a failed fetch into the set its values
+// were a mix of two forecasts, so every data point is reported changed
+inline void dswSaveChanges(uint32_t *changes, DS_Weather &dsw, bool partial)
+{
+  static const uint32_t all[DSW_SECTIONS] = { DSW_CURRENT_ALL, DSW_MINUTELY_ALL,
+                                              DSW_HOURLY_ALL, DSW_DAILY_ALL };
+  for (uint8_t s = 0; s < DSW_SECTIONS; s++) changes[s] = partial ? all[s] : dsw.changes(s);
+}
+
+// One set of structs
+template <class C, class M, class H, class D>
+struct DSW_forecast {
+  C current;
+  M minutely;
+  H hourly;
+  D daily;
+
+  DSW_summary_pool summaries; // For compact struct summaries
+  uint32_t generation;        // DSW_background::generation() when it was published, or
+                              // the DSW_pool::round() it was fetched in
+  uint32_t changes[DSW_SECTIONS]; // DS_Weather::changes() of each section when it was filled
+};
+
+#if defined(ESP32) || defined(DSW_STD_THREAD)
+
+#include <atomic>
+
+#ifdef DSW_STD_THREAD
+  #include <thread>
+#endif
+
+#define DSW_TASK_STACK    8192 // Bytes, the TLS handshake needs most of it
+#define DSW_TASK_PRIORITY 1
+#define DSW_TASK_CORE     0    // loop() runs on core 1
+
+/***************************************************************************************
+** Description:   Non template part, the task and the buffer swap. The code is in
+**                DarkSkyWeather.cpp
+***************************************************************************************/
+class DSW_worker {
+
+  public:
+    void end();     // Stop the task, waits for a fetch in progress to finish
+    void refresh(); // Fetch now instead of at the next interval
+
+    // Forecasts published, 0 until the first. It changes when new data arrives
+    uint32_t generation() const { return published; }
+    uint32_t failures()   const { return failed; }   // Fetches that did not succeed
+    bool     running()    const { return active; }
+
+    DSW_worker(const DSW_worker &) = delete;
+    DSW_worker &operator=(const DSW_worker &) = delete;
+
+  protected:
+    DSW_worker() { readers[0] = 0; readers[1] = 0; }
+    ~DSW_worker() { end(); }
+
+    bool start(uint32_t interval); // Seconds between fetches
+
+    // Set of the newest forecast with its reader count raised, -1 if none yet
+    int8_t acquireSet();
+    void   releaseSet(uint8_t set) { readers[set]--; }
+
+    // Fill set, true if it is complete and can be published
+    virtual bool fetch(uint8_t set) = 0;
+
+  private:
+    void run();
+    static void entry(void *worker);
+
+    std::atomic<uint32_t> front { 0 };       // Set the sketch reads
+    std::atomic<uint32_t> readers[2];        // Sketch references to each set
+    std::atomic<uint32_t> published { 0 };
+    std::atomic<uint32_t> failed { 0 };
+    std::atomic<bool>     active { false };  // Task running
+    std::atomic<bool>     stopping { false };
+    std::atomic<bool>     refreshNow { false };
+    uint32_t              interval;          // Milliseconds
+
+#ifdef DSW_STD_THREAD
+    std::thread           task;
+#endif
+};
+
+/***************************************************************************************
+** Description:   Background fetch of the C, M, H and D struct types
+***************************************************************************************/
+template <class C, class M = DSW_none, class H = DSW_none, class D = DSW_none>
+class DSW_background : public DSW_worker {
+
+  public:
+    typedef DSW_forecast<C, M, H, D> forecast_t;
+
+    DSW_background() { }
+    ~DSW_background() { end(); } // Stop the task before the sets go
+
+    // The DS_Weather used by the task, set its options before begin()
+    DS_Weather &weather() { return dsw; }
+
+    // Start the task, the first fetch is made straight away then every interval seconds.
+    // false if the task is running or could not be created
+    bool begin(String api_key, String latitude, String longitude,
+               String units, String language, uint32_t interval)
+    {
+      if (running()) return false;
+
+      this->api_key   = api_key;
+      this->latitude  = latitude;
+      this->longitude = longitude;
+      this->units     = units;
+      this->language  = language;
+
+      return start(interval);
+    }
+
+    // The newest forecast, nullptr before the first. Call release() when done with it
+    const forecast_t *acquire()
+    {
+      int8_t set = acquireSet();
+      return (set < 0) ? nullptr : &sets[set];
+    }
+
+    void release(const forecast_t *forecast)
+    {
+      if (forecast) releaseSet(forecast - sets);
+    }
+
+  private:
+    bool fetch(uint8_t set) override
+    {
+      forecast_t &f = sets[set];
+
+      dswSectionRestart(f.current);
+      dswSectionRestart(f.minutely);
+      dswSectionRestart(f.hourly);
+      dswSectionRestart(f.daily);
+
+      dsw.setSummaryPool(&f.summaries);
+      if (!dsw.getForecast(dswSection(f.current), dswSection(f.minutely),
+                           dswSection(f.hourly), dswSection(f.daily),
+                           api_key, latitude, longitude, units, language))
+      {
+        partial[set] = true;
+        return false;
+      }
+
+      dswSaveChanges(f.changes, dsw, partial[set]);
+      partial[set] = false;
+
+      f.generation = generation() + 1;
+      return true;
+    }
+
+    DS_Weather dsw;
+    forecast_t sets[2];
+    bool       partial[2] = { false, false }; // Set holds part of a failed fetch
+
+    String api_key, latitude, longitude, units, language;
+};
+
+#endif // ESP32 or DSW_STD_THREAD
+
+#endif
@@ -0,0 +1,225 @@
+// Compact forecast storage for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// The DSW_minutely_c, DSW_hourly_c and DSW_daily_c templates hold the same data points as
+// the DSW_minutely_t etc structs in about half the RAM. Values are stored as fixed point
+// integers and times as offsets from one base time per section:
+//
+//   time, sunriseTime, sunsetTime  uint8_t minutes (minutely), uint8_t hours (hourly),
+//                                  uint16_t minutes (daily), sunrise/sunset are rounded
+//   temperature                    int16_t hundredths of a degree
+//   pressure                       uint16_t tenths of a hPa (or mbar)
+//   precipIntensity                uint16_t thousandths, maximum 65.535
+//   precipAccumulation             uint16_t hundredths, maximum 655.35
+//   windSpeed, windGust            uint16_t hundredths, maximum 655.35
+//
+// Array values are read with accessor functions that return the usual units and types,
+// e.g. hourly->temperature(3) returns a float and daily->sunriseTime(1) a unix time.
+// Section values outside the arrays (e.g. overallSummary) are members as in the structs.
+//
+// The hourly and daily summaries repeat a few phrases ("Partly Cloudy", "Clear" etc), so
+// each is held once in a DSW_text_pool shared by all the compact structs of a forecast
+// and the struct keeps a one byte index. summary(i) returns a const char* into the pool,
+// "" if not received or if no pool was set with setSummaryPool().
+//
+//   DSW_summary_pool summaries;                  // Normally a global
+//   dsw.setSummaryPool(&summaries);
+//
+//   DSW_hourly_compact *hourly = new DSW_hourly_compact;
+//   dsw.getForecast(current, nullptr, hourly, daily, api_key, ...);
+//   Serial.println(hourly->temperature(3));
+//   Serial.println(hourly->summary(3));
+//
+// The pool is emptied at the start of each forecast. poolUsed() and count() show how much
+// of it the last forecast needed, overflow() is true if a summary did not fit.
+
+#ifndef DSW_Compact_h
+#define DSW_Compact_h
+
+#ifndef DSW_SUMMARY_POOL
+  #define DSW_SUMMARY_POOL  512 // Default summary pool bytes
+#endif
+#ifndef DSW_SUMMARY_TEXTS
+  #define DSW_SUMMARY_TEXTS 32  // Default maximum different summaries, 254 maximum
+#endif
+
+#define DSW_TEXT_NONE 0xFF // Summary index if not received
+
+/***************************************************************************************
+** Description:   Pool of different summary texts, the code is in DarkSkyWeather.cpp
+***************************************************************************************/
+class DSW_text_pool {
+
+  public:
+    uint8_t add(const char *text);          // Index of text, DSW_TEXT_NONE if no room
+    const char *text(uint8_t index) const;  // "" for DSW_TEXT_NONE
+    void clear();
+
+    uint8_t  count()    const { return texts; }   // Different texts held
+    uint16_t poolUsed() const { return used; }    // Bytes used
+    uint16_t poolSize() const { return poolBytes; }
+    bool     overflow() const { return dropped; } // true if a text did not fit
+
+    DSW_text_pool(const DSW_text_pool &) = delete; // The pointers are to the derived class
+    DSW_text_pool &operator=(const DSW_text_pool &) = delete;
+
+  protected:
+    DSW_text_pool(char *pool, uint16_t size, uint16_t *offset, uint8_t n)
+      : pool(pool), poolBytes(size), offset(offset), n(n) { clear(); }
+
+  private:
+    char     *pool;      // Texts, each null terminated
+    uint16_t  poolBytes; // Pool size
+    uint16_t  used;      // Pool bytes used
+    uint16_t *offset;    // Pool offset of each text
+    uint8_t   n;         // Texts that can be held
+    uint8_t   texts;     // Texts held
+    bool      dropped;   // A text did not fit
+};
+
+// P pool bytes, N maximum different texts
+template <uint16_t P = DSW_SUMMARY_POOL, uint8_t N = DSW_SUMMARY_TEXTS>
+class DSW_text_pool_t : public DSW_text_pool {
+  public:
+    DSW_text_pool_t() : DSW_text_pool(pool, P, offset, N) { }
+  private:
+    char     pool[P];
+    uint16_t offset[N];
+};
+
+typedef DSW_text_pool_t<> DSW_summary_pool;
+
+// Time offset type and step in seconds for each section
+#define DSW_MINUTELY_TIME_T    uint8_t
+#define DSW_MINUTELY_TIME_STEP 60
+#define DSW_HOURLY_TIME_T      uint8_t
+#define DSW_HOURLY_TIME_STEP   3600
+#define DSW_DAILY_TIME_T       uint16_t
+#define DSW_DAILY_TIME_STEP    60
+
+// Compact storage type and initial value of each kind of value
+#define DSW_CTYPE_TEXT(S)      uint8_t  // DSW_text_pool index
+#define DSW_CTYPE_UNIX(S)      DSW_##S##_TIME_T
+#define DSW_CTYPE_U16(S)       uint16_t
+#define DSW_CTYPE_PCT(S)       uint8_t
+#define DSW_CTYPE_ICON(S)      uint8_t
+#define DSW_CTYPE_PTYPE(S)     uint8_t
+#define DSW_CTYPE_FLOAT(S)     float
+#define DSW_CTYPE_TEMP(S)      int16_t
+#define DSW_CTYPE_PRESS(S)     uint16_t
+#define DSW_CTYPE_RATE(S)      uint16_t
+#define DSW_CTYPE_ACCUM(S)     uint16_t
+#define DSW_CTYPE_SPEED(S)     uint16_t
+
+#define DSW_CINIT_TEXT(S)      DSW_TEXT_NONE
+#define DSW_CINIT_UNIX(S)      ((DSW_##S##_TIME_T)~0) // No time received
+#define DSW_CINIT_PTYPE(S)     NO_VALUE
+#define DSW_CINIT_U16(S)       0
+#define DSW_CINIT_PCT(S)       0
+#define DSW_CINIT_ICON(S)      0
+#define DSW_CINIT_FLOAT(S)     0
+#define DSW_CINIT_TEMP(S)      0
+#define DSW_CINIT_PRESS(S)     0
+#define DSW_CINIT_RATE(S)      0
+#define DSW_CINIT_ACCUM(S)     0
+#define DSW_CINIT_SPEED(S)     0
+
+// Accessor returning the value in the usual units, D is the struct holding timeBase
+#define DSW_CGET_TEXT(S, m)                                                             \
+  const char *m(uint16_t i) const {                                                     \
+    const DSW_text_pool *p = static_cast<const D *>(this)->textPool;                    \
+    return p ? p->text(m##_c[i]) : "";                                                  \
+  }
+#define DSW_CGET_U16(S, m)     uint16_t m(uint16_t i) const { return m##_c[i]; }
+#define DSW_CGET_PCT(S, m)     uint8_t  m(uint16_t i) const { return m##_c[i]; }
+#define DSW_CGET_ICON(S, m)    uint8_t  m(uint16_t i) const { return m##_c[i]; }
+#define DSW_CGET_PTYPE(S, m)   uint8_t  m(uint16_t i) const { return m##_c[i]; }
+#define DSW_CGET_FLOAT(S, m)   float    m(uint16_t i) const { return m##_c[i]; }
+#define DSW_CGET_TEMP(S, m)    float    m(uint16_t i) const { return m##_c[i] / 100.0f; }
+#define DSW_CGET_PRESS(S, m)   float    m(uint16_t i) const { return m##_c[i] / 10.0f; }
+#define DSW_CGET_RATE(S, m)    float    m(uint16_t i) const { return m##_c[i] / 1000.0f; }
+#define DSW_CGET_ACCUM(S, m)   float    m(uint16_t i) const { return m##_c[i] / 100.0f; }
+#define DSW_CGET_SPEED(S, m)   float    m(uint16_t i) const { return m##_c[i] / 100.0f; }
+#define DSW_CGET_UNIX(S, m)                                                             \
+  uint32_t m(uint16_t i) const {                                                        \
+    if (m##_c[i] == DSW_CINIT_UNIX(S)) return 0;                                        \
+    return static_cast<const D *>(this)->timeBase + (uint32_t)m##_c[i] * DSW_##S##_TIME_STEP; \
+  }
+
+/***************************************************************************************
+** Description:   One struct template per array data point, empty if not selected
+***************************************************************************************/
+#define DSW_COMPACT_MEMBER(S, s, m, k, kind)                                            \
+  template <bool on, uint16_t N, class D> struct dsw_##s##_##m##_c {                    \
+    void dswBind(dsw_binding_t &) {}                                                    \
+    void dswReset(uint16_t) {}                                                          \
+  };                                                                                    \
+  template <uint16_t N, class D> struct dsw_##s##_##m##_c<true, N, D> {                 \
+    DSW_CTYPE_##kind(S) m##_c[N];                                                       \
+    dsw_##s##_##m##_c() { for (uint16_t i = 0; i < N; i++) m##_c[i] = DSW_CINIT_##kind(S); } \
+    DSW_CGET_##kind(S, m)                                                               \
+    void dswBind(dsw_binding_t &b) { b.slot[DSW_FIELD_##s##_##m] = m##_c; }             \
+    void dswReset(uint16_t n) { for (uint16_t i = 0; i < n; i++) m##_c[i] = DSW_CINIT_##kind(S); } \
+  };
+
+DSW_MINUTELY_ARRAYS(DSW_COMPACT_MEMBER, MINUTELY, minutely)
+DSW_HOURLY_ARRAYS(DSW_COMPACT_MEMBER, HOURLY, hourly)
+DSW_DAILY_ARRAYS(DSW_COMPACT_MEMBER, DAILY, daily)
+
+#define DSW_COMPACT_BASE(S, s, m, k, kind) public dsw_##s##_##m##_c<(F & DSW_##S##_##m) != 0, N, DSW_##s##_c<F, N> >,
+#define DSW_COMPACT_BIND(S, s, m, k, kind) dsw_##s##_##m##_c<(F & DSW_##S##_##m) != 0, N, DSW_##s##_c<F, N> >::dswBind(b);
+#define DSW_COMPACT_RESET(S, s, m, k, kind) dsw_##s##_##m##_c<(F & DSW_##S##_##m) != 0, N, DSW_##s##_c<F, N> >::dswReset(records);
+
+// Body common to the compact structs, the time base is set by the first time received
+#define DSW_COMPACT_BODY(S, s)                                                          \
+  uint32_t timeBase = 0;                                                                \
+  const DSW_text_pool *textPool = nullptr; /* Summaries of the last forecast */         \
+  uint16_t records = 0; /* "data" elements holding values */                            \
+  static const uint32_t fields = F;                                                     \
+  static const uint16_t size = N;                                                       \
+  void dswBind(dsw_binding_t &b) {                                                      \
+    DSW_##S##_SCALARS(DSW_SCALAR_BIND, S, s)                                            \
+    DSW_##S##_ARRAYS(DSW_COMPACT_BIND, S, s)                                            \
+    b.fields[DSW_##S] = F;                                                              \
+    b.size[DSW_##S] = N;                                                                \
+    b.timeBase[DSW_##S] = &timeBase;                                                    \
+    b.records[DSW_##S] = &records;                                                      \
+    textPool = b.textPool;                                                              \
+  }                                                                                     \
+  void reset() { /* Only the elements that were filled */                              \
+    DSW_##S##_SCALARS(DSW_SCALAR_RESET, S, s)                                           \
+    DSW_##S##_ARRAYS(DSW_COMPACT_RESET, S, s)                                           \
+    records = 0;                                                                        \
+    timeBase = 0;                                                                       \
+  }
+
+/***************************************************************************************
+** Description:   Compact structures for minutely, hourly and daily weather
+***************************************************************************************/
+template <uint32_t F = DSW_MINUTELY_ALL, uint16_t N = MAX_MINUTES>
+struct DSW_minutely_c : DSW_MINUTELY_SCALARS(DSW_SCALAR_BASE, MINUTELY, minutely)
+                        DSW_MINUTELY_ARRAYS(DSW_COMPACT_BASE, MINUTELY, minutely) dsw_fields_end {
+  DSW_COMPACT_BODY(MINUTELY, minutely)
+};
+
+template <uint32_t F = DSW_HOURLY_ALL, uint16_t N = MAX_HOURS>
+struct DSW_hourly_c : DSW_HOURLY_SCALARS(DSW_SCALAR_BASE, HOURLY, hourly)
+                      DSW_HOURLY_ARRAYS(DSW_COMPACT_BASE, HOURLY, hourly) dsw_fields_end {
+  DSW_COMPACT_BODY(HOURLY, hourly)
+};
+
+template <uint32_t F = DSW_DAILY_ALL, uint16_t N = MAX_DAYS>
+struct DSW_daily_c : DSW_DAILY_SCALARS(DSW_SCALAR_BASE, DAILY, daily)
+                     DSW_DAILY_ARRAYS(DSW_COMPACT_BASE, DAILY, daily) dsw_fields_end {
+  DSW_COMPACT_BODY(DAILY, daily)
+};
+
+typedef DSW_minutely_c<> DSW_minutely_compact;
+typedef DSW_hourly_c<>   DSW_hourly_compact;
+typedef DSW_daily_c<>    DSW_daily_compact;
+
+#endif
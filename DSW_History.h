@@ -0,0 +1,119 @@
+// Forecast history for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// A DSW_history keeps a compact snapshot of the current weather (and optionally the
+// first hourly data point) from each successful forecast in a fixed size ring buffer,
+// the oldest snapshot is replaced when it is full. The snapshot values are taken while
+// the response is parsed, so they are recorded even if the DSW_current struct does not
+// store them:
+//
+//   DSW_history_t<48> history;                  // 48 forecasts, e.g. 12 hours at 15 min
+//   dsw.setHistory(&history);
+//   ...
+//   DSW_history_stats st;
+//   if (history.stats(DSW_HISTORY_pressure, 6 * 3600, &st) && st.slope < -1.0) ...
+//
+// serialize() copies the history to a byte array that can be saved (e.g. SPIFFS or RTC
+// memory) and deserialize() restores it after a reboot.
+
+#ifndef DSW_History_h
+#define DSW_History_h
+
+// Values are held as fixed point numbers, see DSW_Compact.h
+typedef struct DSW_snapshot {
+  uint32_t time;                  // Current weather time, unix
+  int16_t  temperature;           // Hundredths of a degree
+  uint16_t pressure;              // Tenths
+  uint16_t windSpeed;             // Hundredths
+  uint16_t windBearing;           // Degrees
+  uint16_t precipIntensity;       // Thousandths
+  uint8_t  humidity;              // Percent
+  uint8_t  cloudCover;            // Percent
+  uint8_t  precipProbability;     // Percent
+  uint8_t  icon;                  // Icon index
+  int16_t  hourlyTemperature;     // First hourly data point, if enabled by setHistory()
+  uint16_t hourlyPrecipIntensity;
+  uint8_t  hourlyPrecipProbability;
+} DSW_snapshot;
+
+// Snapshot values for DSW_history::value() and stats()
+enum dsw_history_value_t : uint8_t {
+  DSW_HISTORY_temperature,
+  DSW_HISTORY_pressure,
+  DSW_HISTORY_windSpeed,
+  DSW_HISTORY_windBearing,
+  DSW_HISTORY_precipIntensity,
+  DSW_HISTORY_humidity,
+  DSW_HISTORY_cloudCover,
+  DSW_HISTORY_precipProbability,
+  DSW_HISTORY_hourlyTemperature,
+  DSW_HISTORY_hourlyPrecipIntensity,
+  DSW_HISTORY_hourlyPrecipProbability
+};
+
+typedef struct DSW_history_stats {
+  uint16_t n;     // Snapshots in the window
+  float    min;
+  float    max;
+  float    slope; // Least squares change per hour
+} DSW_history_stats;
+
+/***************************************************************************************
+** Description:   Non template part of the history, the code is in DarkSkyWeather.cpp
+***************************************************************************************/
+class DSW_history {
+
+  public:
+    void add(const DSW_snapshot &snapshot); // Oldest is replaced when full
+    void clear() { head = 0; count = 0; }
+
+    uint16_t size()     const { return count; }
+    uint16_t capacity() const { return n; }
+
+    // Snapshot i, 0 is the newest, size() - 1 the oldest
+    const DSW_snapshot &get(uint16_t i) const { return ring[(head + n - 1 - i) % n]; }
+
+    // Value of a snapshot in the usual units
+    static float value(const DSW_snapshot &snapshot, uint8_t id);
+
+    // Statistics of a value over the snapshots up to window seconds older than the
+    // newest, false if there are none
+    bool stats(uint8_t id, uint32_t window, DSW_history_stats *stats) const;
+
+    // Bytes needed by serialize()
+    size_t serializedSize() const;
+
+    // Copy the history to buffer, returns the bytes used or 0 if it is too small
+    size_t serialize(uint8_t *buffer, size_t length) const;
+
+    // Restore a history from serialize(), false if the data is not valid (history cleared)
+    bool deserialize(const uint8_t *buffer, size_t length);
+
+    DSW_history(const DSW_history &) = delete; // ring points to the derived class
+    DSW_history &operator=(const DSW_history &) = delete;
+
+  protected:
+    DSW_history(DSW_snapshot *ring, uint16_t n) : ring(ring), n(n) { clear(); }
+
+  private:
+    DSW_snapshot *ring;
+    uint16_t      n;     // Snapshots that can be held
+    uint16_t      head;  // Next snapshot written
+    uint16_t      count; // Snapshots held
+};
+
+// N snapshots
+template <uint16_t N>
+class DSW_history_t : public DSW_history {
+  static_assert(N > 0, "History needs at least one snapshot");
+  public:
+    DSW_history_t() : DSW_history(ring, N) { }
+  private:
+    DSW_snapshot ring[N];
+};
+
+#endif
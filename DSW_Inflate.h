@@ -0,0 +1,139 @@
+// Streaming gzip/deflate decoder for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// The forecast JSON compresses to about a fifth of its size, so asking the server for a
+// gzip response cuts the bytes sent over WiFi and through TLS. A DSW_inflate decodes the
+// response as it arrives and the decompressed bytes go straight to the parser, only the
+// window of recent output that deflate back references need is held:
+//
+//   DSW_inflate_t<8192> inflater;              // 8 kbyte window, normally a global
+//   dsw.setInflater(&inflater);                // Requests now ask for gzip
+//   ...
+//   dsw.getForecast(...);
+//   Serial.println(inflater.bytesIn());        // Compressed bytes received
+//   Serial.println(inflater.bytesOut());       // JSON bytes parsed
+//   Serial.println(inflater.maxDistance());    // Window the response needed
+//
+// The server may compress with a 32 kbyte window, but JSON repeats itself at short range
+// so a smaller window normally suffices. If a back reference is further back than the
+// window holds, error() is DSW_INFLATE_WINDOW and the request is sent again at once
+// without asking for gzip. Later requests do not ask for gzip either, call setInflater()
+// with a larger window to try again.
+//
+// gzip, zlib and raw deflate streams are accepted. The gzip CRC is not checked (TLS has
+// already checked the data), the uncompressed size is.
+
+#ifndef DSW_Inflate_h
+#define DSW_Inflate_h
+
+// error() values
+#define DSW_INFLATE_OK     0
+#define DSW_INFLATE_FORMAT 1 // Not a gzip, zlib or deflate stream, or a corrupt one
+#define DSW_INFLATE_WINDOW 2 // Back reference further than the window, see maxDistance()
+#define DSW_INFLATE_LENGTH 3 // gzip uncompressed size check failed
+
+/***************************************************************************************
+** Description:   Non template part of the decoder, the code is in DarkSkyWeather.cpp
+***************************************************************************************/
+class DSW_inflate {
+
+  public:
+    void begin(); // Start a new stream
+
+    // Decompress from in until all of it is used or the output reaches the end of the
+    // window. Returns the input bytes used, *out and *outCount are set to the new output
+    // (held in the window until the next call). Call again while either is not zero.
+    int inflate(const uint8_t *in, int count, const uint8_t **out, int *outCount);
+
+    bool     done()  const { return state == DSW_INF_DONE; }
+    uint8_t  error() const { return fault; }
+
+    uint32_t windowSize()  const { return (uint32_t)mask + 1; }
+    uint32_t bytesIn()     const { return received; } // Since begin()
+    uint32_t bytesOut()    const { return produced; }
+    uint16_t maxDistance() const { return furthest; } // Furthest back reference since begin()
+
+    DSW_inflate(const DSW_inflate &) = delete; // window points to the derived class
+    DSW_inflate &operator=(const DSW_inflate &) = delete;
+
+  protected:
+    DSW_inflate(uint8_t *window, uint16_t size) : window(window), mask(size - 1) { begin(); }
+
+  private:
+    enum : uint8_t {
+      DSW_INF_HEADER,   // gzip or zlib header
+      DSW_INF_BLOCK,    // Block header
+      DSW_INF_STORED,   // Stored block length
+      DSW_INF_COPY,     // Stored block data
+      DSW_INF_TABLE,    // Dynamic block code counts
+      DSW_INF_LENLENS,  // Code length code lengths
+      DSW_INF_CODELENS, // Literal/length and distance code lengths
+      DSW_INF_CODES,    // Literal/length symbol
+      DSW_INF_LENGTH,   // Length extra bits
+      DSW_INF_DIST,     // Distance symbol
+      DSW_INF_DISTEXT,  // Distance extra bits
+      DSW_INF_MATCH,    // Copy of earlier output
+      DSW_INF_TRAILER,  // gzip or zlib trailer
+      DSW_INF_DONE,
+      DSW_INF_FAILED
+    };
+
+    bool need(uint8_t bits);                // Fill the bit buffer, false if input ran out
+    uint32_t bits(uint8_t n);               // Take n bits, need(n) must be true
+    int  decode(const uint16_t *count, const uint16_t *symbol); // Next symbol, -1 if input ran out
+    bool build(uint16_t *count, uint16_t *symbol, const uint8_t *lengths, uint16_t n); // false if invalid
+    void fixed();                           // Fixed Huffman codes
+    bool put(uint8_t b) { window[produced++ & mask] = b; return (produced & mask) == 0; } // true at window end
+    bool header();                          // Step through the gzip/zlib header
+    bool trailer();
+    bool fail(uint8_t code) { fault = code; state = DSW_INF_FAILED; return false; }
+
+    uint8_t  *window;
+    uint16_t  mask;      // Window size - 1, the size is a power of 2
+
+    const uint8_t *next; // Input not yet in the bit buffer
+    int       avail;
+    uint32_t  bitBuffer; // Input bits, the next is bit 0
+    uint8_t   bitCount;
+
+    uint8_t   state;
+    uint8_t   fault;
+    bool      last;      // Final block
+    uint8_t   format;    // 0 raw deflate, 1 gzip, 2 zlib
+    uint8_t   flags;     // gzip header flags still to skip
+    uint16_t  step;      // Header/trailer byte or code length count
+    uint16_t  length;    // Stored block or match bytes left
+    uint16_t  symbol;    // Length or distance symbol waiting for extra bits
+    uint16_t  distance;
+    uint16_t  furthest;
+
+    uint16_t  nlen, ndist, ncode; // Dynamic block code counts
+    uint8_t   lengths[288 + 32];  // Code lengths being read
+
+    uint32_t  received;
+    uint32_t  produced;  // Bytes output since begin(), the window position is produced & mask
+    uint32_t  isize;     // gzip trailer size
+
+    // Canonical Huffman codes, the count of codes of each length and the symbols in code
+    // order. The distance code also holds the code length code of a dynamic block.
+    uint16_t  lenCount[16];
+    uint16_t  lenSymbol[288];
+    uint16_t  distCount[16];
+    uint16_t  distSymbol[32];
+};
+
+// W window bytes, a power of 2 from 256 to 32768
+template <uint16_t W>
+class DSW_inflate_t : public DSW_inflate {
+  static_assert(W >= 256 && W <= 32768 && (W & (W - 1)) == 0, "Window must be a power of 2 from 256 to 32768");
+  public:
+    DSW_inflate_t() : DSW_inflate(window, W) { }
+  private:
+    uint8_t window[W];
+};
+
+#endif
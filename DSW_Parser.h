@@ -0,0 +1,352 @@
+// Streaming JSON parser for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// This parser is bound to the listener class at compile time (a template parameter)
+// instead of calling it through the virtual functions of JsonListener. The callbacks
+// are normal member calls the compiler can inline, and whitespace() is only called if
+// the listener sets "parseWhitespace" true, otherwise whitespace costs nothing.
+
+// The listener class must provide these functions (they may be private if the class
+// declares "template <class L> friend class DSW_Parser;"):
+//   startDocument(), endDocument(), startObject(), endObject(), startArray(),
+//   endArray(), key(const char*), value(const char*), error(const char*),
+//   whitespace(char), bool skipValue() and a "static const bool parseWhitespace" member.
+
+// skipValue() is called after each key(), if it returns true the value for that key
+// (a string, number or a whole nested object or array) is scanned past without any
+// callbacks or buffering. The listener uses this for values it does not store.
+
+// The callbacks are the same as the JSON_Decoder library, so a JsonListener class
+// works with either parser: https://github.com/Bodmer/JSON_Decoder
+
+#ifndef DSW_Parser_h
+#define DSW_Parser_h
+
+#ifndef DSW_VALUE_SIZE
+  #define DSW_VALUE_SIZE 512 // Longest key or value string, longer ones are truncated
+#endif
+
+#define DSW_PARSER_DEPTH 32  // Maximum object and array nesting (bits in a uint32_t)
+
+/***************************************************************************************
+** Description:   Template bound streaming parser class
+***************************************************************************************/
+template <class L>
+class DSW_Parser {
+
+  public:
+
+    DSW_Parser() { reset(); }
+
+    void setListener(L *listener) { this->listener = listener; }
+
+    // Back to the start of document state, e.g. before a new message
+    void reset() {
+      state = START;
+      depth = 0;
+      arrays = 0;
+      length = 0;
+    }
+
+    // Parse a block of characters, values being skipped are scanned in a tight loop
+    void parse(const uint8_t *buffer, size_t count) {
+      const uint8_t *end = buffer + count;
+      while (buffer < end) {
+        if (state >= SKIP_VALUE) {
+          buffer = skip(buffer, end);
+          if (buffer >= end) break;
+        }
+        parse((char)*buffer++);
+      }
+    }
+
+    // Parse one character
+    inline void parse(char c) {
+
+      if (state >= SKIP_VALUE) {
+        const uint8_t *p = (const uint8_t *)&c;
+        if (skip(p, p + 1) != p) return; // Character was part of the skipped value
+      }
+
+      switch (state) {
+
+        case IN_STRING:
+          if (c == '"') { endString(); return; }
+          if (c == '\\') { state = IN_ESCAPE; return; }
+          addChar(c);
+          return;
+
+        case IN_NUMBER:
+          if ((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E') {
+            addChar(c);
+            return;
+          }
+          endValue();
+          break; // Character ends the number, so process it below
+
+        case IN_LITERAL:
+          if (c >= 'a' && c <= 'z') { addChar(c); return; }
+          endLiteral();
+          if (state == DONE) return;
+          break; // Character ends true, false or null, so process it below
+
+        case IN_ESCAPE:
+          state = IN_STRING;
+          switch (c) {
+            case 'b': addChar('\b'); return;
+            case 'f': addChar('\f'); return;
+            case 'n': addChar('\n'); return;
+            case 'r': addChar('\r'); return;
+            case 't': addChar('\t'); return;
+            case 'u': state = IN_UNICODE; unicode = 0; hexCount = 0; return;
+            default:  addChar(c);    return; // '"', '\\' and '/'
+          }
+
+        case IN_UNICODE:
+          addHex(c);
+          return;
+
+        case DONE:
+          return;
+
+        default:
+          break;
+      }
+
+      // Between tokens
+      if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+        if (L::parseWhitespace) listener->L::whitespace(c);
+        return;
+      }
+
+      switch (state) {
+
+        case START:
+          listener->L::startDocument();
+          if (c == '{') startObject();
+          else if (c == '[') startArray();
+          else error("Document must start with object or array");
+          return;
+
+        case EXPECT_KEY:
+          if (c == '"') { isKey = true; state = IN_STRING; return; }
+          if (c == '}' && !inArray()) { endContainer(); return; }
+          error("Expected key");
+          return;
+
+        case AFTER_KEY:
+          if (c == ':') { state = EXPECT_VALUE; return; }
+          error("Expected colon");
+          return;
+
+        case EXPECT_VALUE:
+          startValue(c);
+          return;
+
+        case AFTER_VALUE:
+          if (c == ',') { state = inArray() ? EXPECT_VALUE : EXPECT_KEY; return; }
+          if ((c == '}' && !inArray()) || (c == ']' && inArray())) { endContainer(); return; }
+          error("Expected comma or end");
+          return;
+
+        default:
+          return;
+      }
+    }
+
+  private:
+
+    // The skip states must be last, see parse()
+    enum parser_state_t : uint8_t {
+      START, EXPECT_KEY, AFTER_KEY, EXPECT_VALUE, AFTER_VALUE,
+      IN_STRING, IN_ESCAPE, IN_UNICODE, IN_NUMBER, IN_LITERAL, DONE,
+      SKIP_VALUE, SKIP_STRING, SKIP_ESCAPE, SKIP_SCALAR,
+      SKIP_NESTED, SKIP_NESTED_STRING, SKIP_NESTED_ESCAPE
+    };
+
+    // Scan past a skipped value, returns a pointer to the first character not consumed.
+    // The state is AFTER_VALUE when the value has ended.
+    const uint8_t *skip(const uint8_t *p, const uint8_t *end) {
+
+      while (p < end) {
+        uint8_t c = *p;
+
+        switch (state) {
+
+          case SKIP_VALUE: // Colon and whitespace before the value
+            p++;
+            if (c == ':' || c == ' ' || c == '\n' || c == '\r' || c == '\t') break;
+            if (c == '"') state = SKIP_STRING;
+            else if (c == '{' || c == '[') { nest = 1; state = SKIP_NESTED; }
+            else state = SKIP_SCALAR;
+            break;
+
+          case SKIP_STRING:
+            while (p < end && *p != '"' && *p != '\\') p++;
+            if (p == end) return p;
+            if (*p++ == '\\') { state = SKIP_ESCAPE; break; }
+            state = AFTER_VALUE;
+            return p;
+
+          case SKIP_ESCAPE:
+          case SKIP_NESTED_ESCAPE:
+            p++;
+            state = (state == SKIP_ESCAPE) ? SKIP_STRING : SKIP_NESTED_STRING;
+            break;
+
+          case SKIP_SCALAR: // Number, true, false or null ends at the next delimiter
+            if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+              state = AFTER_VALUE;
+              return p;
+            }
+            p++;
+            break;
+
+          case SKIP_NESTED:
+            p++;
+            if (c == '"') state = SKIP_NESTED_STRING;
+            else if (c == '{' || c == '[') nest++;
+            else if ((c == '}' || c == ']') && --nest == 0) {
+              state = AFTER_VALUE;
+              return p;
+            }
+            break;
+
+          case SKIP_NESTED_STRING:
+            while (p < end && *p != '"' && *p != '\\') p++;
+            if (p == end) return p;
+            state = (*p++ == '"') ? SKIP_NESTED : SKIP_NESTED_ESCAPE;
+            break;
+
+          default:
+            return p;
+        }
+      }
+      return p;
+    }
+
+    bool inArray() { return depth && (arrays & (1UL << (depth - 1))); }
+
+    inline void addChar(char c) {
+      if (length < DSW_VALUE_SIZE - 1) buffer[length++] = c;
+    }
+
+    // Collect 4 hex digits of a \uXXXX escape and add the character as UTF-8
+    void addHex(char c) {
+      uint8_t h;
+      if (c >= '0' && c <= '9') h = c - '0';
+      else if (c >= 'a' && c <= 'f') h = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') h = c - 'A' + 10;
+      else { error("Bad unicode escape"); return; }
+
+      unicode = (unicode << 4) | h;
+      if (++hexCount < 4) return;
+
+      if (unicode < 0x80) addChar((char)unicode);
+      else if (unicode < 0x800) {
+        addChar((char)(0xC0 | (unicode >> 6)));
+        addChar((char)(0x80 | (unicode & 0x3F)));
+      }
+      else {
+        addChar((char)(0xE0 | (unicode >> 12)));
+        addChar((char)(0x80 | ((unicode >> 6) & 0x3F)));
+        addChar((char)(0x80 | (unicode & 0x3F)));
+      }
+      state = IN_STRING;
+    }
+
+    void startValue(char c) {
+      isKey = false;
+      if (c == '"') { state = IN_STRING; return; }
+      if (c == '{') { startObject(); return; }
+      if (c == '[') { startArray(); return; }
+      if (c == '-' || (c >= '0' && c <= '9')) { addChar(c); state = IN_NUMBER; return; }
+      if (c == 't' || c == 'f' || c == 'n') { addChar(c); state = IN_LITERAL; return; }
+      if (c == ']' && inArray()) { endContainer(); return; } // Empty array
+      error("Unexpected character");
+    }
+
+    void endString() {
+      buffer[length] = 0;
+      length = 0;
+      if (isKey) {
+        listener->L::key(buffer);
+        state = listener->L::skipValue() ? SKIP_VALUE : AFTER_KEY;
+      }
+      else { listener->L::value(buffer); state = AFTER_VALUE; }
+    }
+
+    void endValue() {
+      buffer[length] = 0;
+      length = 0;
+      listener->L::value(buffer);
+      state = AFTER_VALUE;
+    }
+
+    void endLiteral() {
+      buffer[length] = 0;
+      if (strcmp(buffer, "true") && strcmp(buffer, "false") && strcmp(buffer, "null")) {
+        length = 0;
+        error("Bad literal");
+        return;
+      }
+      endValue();
+    }
+
+    void startObject() {
+      if (!push(false)) return;
+      listener->L::startObject();
+      state = EXPECT_KEY;
+    }
+
+    void startArray() {
+      if (!push(true)) return;
+      listener->L::startArray();
+      state = EXPECT_VALUE;
+    }
+
+    bool push(bool array) {
+      if (depth >= DSW_PARSER_DEPTH) { error("Nesting too deep"); return false; }
+      if (array) arrays |= (1UL << depth);
+      else arrays &= ~(1UL << depth);
+      depth++;
+      return true;
+    }
+
+    void endContainer() {
+      bool array = inArray();
+      depth--;
+      if (array) listener->L::endArray();
+      else listener->L::endObject();
+
+      if (depth == 0) {
+        listener->L::endDocument();
+        state = DONE;
+      }
+      else state = AFTER_VALUE;
+    }
+
+    void error(const char *message) {
+      listener->L::error(message);
+      state = DONE; // Ignore the rest of the message
+    }
+
+    L *listener = nullptr;
+
+    parser_state_t state;
+    uint8_t  depth;    // Count of open objects and arrays
+    uint32_t arrays;   // Bit n set if level n is an array
+    bool     isKey;    // String being collected is a key
+    uint16_t unicode;  // \uXXXX escape value
+    uint8_t  hexCount; // \uXXXX digits collected
+    uint16_t nest;     // Open objects and arrays in a skipped value
+
+    uint16_t length;   // Characters in buffer
+    char     buffer[DSW_VALUE_SIZE];
+};
+
+#endif
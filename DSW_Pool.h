@@ -0,0 +1,172 @@
+// Forecasts for several locations for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// A DS_Weather holds the state of one request (the struct binding, parse position,
+// response header and client), the icon names are shared by all of them. A DSW_pool has
+// K of these request contexts and a result slot for each of N locations. poll() runs the
+// location requests with up to K in progress at once, each is non-blocking (see
+// DS_Weather::beginForecast()) so the responses arrive and are parsed side by side:
+//
+//   // 4 locations, up to 2 requests at a time
+//   typedef DSW_pool_t<DSW_current, DSW_none, DSW_none, DSW_daily, 4, 2> Sites;
+//   Sites sites;                                  // Normally a global, it is large
+//
+//   sites.setLocation(0, "51.5072", "-0.1276");
+//   sites.setLocation(1, "48.8566", "2.3522");
+//   ...
+//   sites.begin(api_key, units, language);
+//   ...
+//   if (sites.poll() == 0) {                      // Call from loop(), 0 when all done
+//     for (uint8_t i = 0; i < 4; i++) if (sites.ok(i)) draw(i, sites.result(i).current);
+//   }
+//
+// Each request costs a secure client (and its TLS buffers) while it is in progress, so
+// K is normally 2 or 3. setLimit() lowers it while running, e.g. if the heap is short.
+// The TLS handshake of a new request blocks poll(), the client library has none that
+// is non-blocking.
+//
+// A location's slot is filled by its request, so it must not be read while the location
+// is in progress. After a failure the slot holds part of a forecast and ok() is false.
+// The slot is refilled over the location's last forecast, its changes[] are the data
+// points that differ from that one (all of them if the last fetch failed).
+//
+// A context fetches whichever location is next, so its own changes(), aggregates and
+// history would mix locations. Aggregates and history are set per location instead with
+// setAggregates() and setHistory(), the context fetching the location is given them.
+// Other options (e.g. setInflater()) are set per context, see context().
+
+#ifndef DSW_Pool_h
+#define DSW_Pool_h
+
+#include "DSW_Background.h"
+
+#define DSW_POOL_NONE 0xFF // No location
+
+// A location and the state of its request
+typedef struct DSW_location {
+  String  latitude;
+  String  longitude;
+  uint8_t state = DSW_FETCH_IDLE; // DSW_FETCH_DONE etc
+  bool    partial = false;        // Slot holds part of a failed fetch
+
+  DSW_aggregate *aggregates = nullptr; // Set by DSW_pool::setAggregates()
+  uint8_t        aggregateCount = 0;
+  DSW_history   *history = nullptr;    // Set by DSW_pool::setHistory()
+  bool           historyHourly = false;
+} DSW_location;
+
+// A request context and the location it is fetching
+typedef struct DSW_pool_context {
+  DS_Weather dsw;
+  uint8_t    location = DSW_POOL_NONE;
+} DSW_pool_context;
+
+/***************************************************************************************
+** Description:   Non template part, the request scheduling. The code is in
+**                DarkSkyWeather.cpp
+***************************************************************************************/
+class DSW_pool {
+
+  public:
+    // Location i, a location with no latitude is not fetched
+    void setLocation(uint8_t i, String latitude, String longitude);
+
+    // Statistics of location i, as DS_Weather::setAggregates() and setHistory()
+    void setAggregates(uint8_t i, DSW_aggregate *list, uint8_t count);
+    void setHistory(uint8_t i, DSW_history *history, bool hourly = false);
+
+    // Requests in progress at once, from 1 to the number of contexts
+    void setLimit(uint8_t limit);
+
+    // Queue a request for every location, false if the last round is still running
+    bool begin(String api_key, String units, String language);
+
+    // Advance the requests in progress and start queued ones, returns the number of
+    // locations still queued or in progress
+    uint8_t poll();
+
+    // Stop the round, locations not finished are failed
+    void cancel();
+
+    uint8_t state(uint8_t i) const { return site[i].state; } // DSW_FETCH_DONE etc
+    bool    ok(uint8_t i)    const { return site[i].state == DSW_FETCH_DONE; }
+
+    uint32_t round()     const { return rounds; } // begin() calls
+    uint8_t  locations() const { return siteCount; }
+    uint8_t  contexts()  const { return contextCount; }
+
+    // Request context c, e.g. to set its options. Do not start requests on it
+    DS_Weather &context(uint8_t c) { return pool[c].dsw; }
+
+    DSW_pool(const DSW_pool &) = delete; // The arrays are in the derived class
+    DSW_pool &operator=(const DSW_pool &) = delete;
+
+  protected:
+    DSW_pool(DSW_pool_context *pool, uint8_t contextCount, DSW_location *site, uint8_t siteCount)
+      : site(site), pool(pool), contextCount(contextCount), limit(contextCount), siteCount(siteCount) { }
+
+    // beginForecast() on dsw for location i into its slot, false if it did not start
+    virtual bool start(DS_Weather &dsw, uint8_t i) = 0;
+
+    // Location i has been fetched into its slot by dsw
+    virtual void finish(DS_Weather &dsw, uint8_t i) = 0;
+
+    String api_key, units, language;
+    DSW_location *site;
+
+  private:
+    DSW_pool_context *pool;
+    uint8_t  contextCount;
+    uint8_t  limit;
+    uint8_t  siteCount;
+    uint8_t  next = 0;   // Next location to start
+    uint32_t rounds = 0;
+};
+
+/***************************************************************************************
+** Description:   N locations of C, M, H and D struct types, K requests at a time
+***************************************************************************************/
+template <class C, class M, class H, class D, uint8_t N, uint8_t K = 1>
+class DSW_pool_t final : public DSW_pool {
+  static_assert(N > 0 && N < DSW_POOL_NONE && K > 0, "Pool needs 1 to 254 locations and a context");
+  public:
+    typedef DSW_forecast<C, M, H, D> forecast_t;
+
+    DSW_pool_t() : DSW_pool(requests, K, sites, N) { }
+
+    // Slot of location i, generation is the round() it was last fetched in and changes
+    // compare with the forecast fetched before
+    const forecast_t &result(uint8_t i) const { return slots[i]; }
+
+  private:
+    bool start(DS_Weather &dsw, uint8_t i) override
+    {
+      forecast_t &f = slots[i];
+
+      dswSectionRestart(f.current);
+      dswSectionRestart(f.minutely);
+      dswSectionRestart(f.hourly);
+      dswSectionRestart(f.daily);
+      f.generation = round();
+
+      dsw.setSummaryPool(&f.summaries);
+      return dsw.beginForecast(dswSection(f.current), dswSection(f.minutely),
+                               dswSection(f.hourly), dswSection(f.daily),
+                               api_key, site[i].latitude, site[i].longitude, units, language);
+    }
+
+    void finish(DS_Weather &dsw, uint8_t i) override
+    {
+      dswSaveChanges(slots[i].changes, dsw, site[i].partial);
+    }
+
+    forecast_t       slots[N];
+    DSW_location     sites[N];
+    DSW_pool_context requests[K]; // Last, so the requests stop before the slots go
+};
+
+#endif
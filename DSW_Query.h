@@ -0,0 +1,208 @@
+// Time indexed forecast queries for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// A DSW_query answers "what is the forecast at time t" from the minutely, hourly and
+// daily structs filled by getForecast(). The "data" element holding t is found with a
+// binary search of the time[] array and numeric values are interpolated linearly
+// between that element and the next. The finest section holding both t and the data
+// point is used, minutely then hourly then daily:
+//
+//   DSW_query<DSW_minutely, DSW_hourly, DSW_daily> query(minutely, hourly, daily);
+//   float t = query.temperature(now() + 90 * 60);   // In 1.5 hours, from hourly
+//   float p = query.precipIntensity(now() + 600);   // In 10 minutes, from minutely
+//   int16_t day = query.index(DSW_DAILY, now());    // Today's element in daily
+//
+// A query returns 0 (or "" for summary) if no section holds t, section() then returns
+// DSW_SECTIONS. A nullptr struct is skipped. The structs must include the time data
+// point and only the elements received (see "records" in Data_Point_Set.h) are searched.
+// Icons, precipType, windBearing, summary and the sunrise and sunset times are not
+// interpolated, the value of the element holding t is returned.
+
+#ifndef DSW_Query_h
+#define DSW_Query_h
+
+#include <type_traits>
+#include <utility>
+
+// Seconds covered by the last element of each section
+#define DSW_MINUTELY_SPAN 60
+#define DSW_HOURLY_SPAN   3600
+#define DSW_DAILY_SPAN    86400
+
+/***************************************************************************************
+** Description:   Data point access for any struct, "has" is false if T lacks member m
+***************************************************************************************/
+// Element i interpolated a fraction f of the way to element i + 1
+#define DSW_QUERY_NUMBER(m)                                                             \
+  template <class T, class = void> struct dsw_query_##m {                               \
+    static const bool has = false;                                                      \
+    static float get(const T *, int16_t, float) { return 0; }                           \
+  };                                                                                    \
+  template <class T> struct dsw_query_##m<T, decltype((void)std::declval<T &>().m[0])> { \
+    static const bool has = true;                                                       \
+    static float get(const T *s, int16_t i, float f) {                                  \
+      if (f == 0) return s->m[i];                                                       \
+      return s->m[i] + ((float)s->m[i + 1] - (float)s->m[i]) * f;                        \
+    }                                                                                   \
+  };
+
+// Element i only
+#define DSW_QUERY_STEP(m, type)                                                         \
+  template <class T, class = void> struct dsw_query_##m {                               \
+    static const bool has = false;                                                      \
+    static type get(const T *, int16_t, float) { return type(); }                       \
+  };                                                                                    \
+  template <class T> struct dsw_query_##m<T, decltype((void)std::declval<T &>().m[0])> { \
+    static const bool has = true;                                                       \
+    static type get(const T *s, int16_t i, float) { return s->m[i]; }                   \
+  };
+
+DSW_QUERY_NUMBER(precipIntensity)
+DSW_QUERY_NUMBER(precipProbability)
+DSW_QUERY_NUMBER(precipAccumulation)
+DSW_QUERY_NUMBER(temperature)
+DSW_QUERY_NUMBER(temperatureHigh)
+DSW_QUERY_NUMBER(temperatureLow)
+DSW_QUERY_NUMBER(humidity)
+DSW_QUERY_NUMBER(pressure)
+DSW_QUERY_NUMBER(windSpeed)
+DSW_QUERY_NUMBER(windGust)
+DSW_QUERY_NUMBER(cloudCover)
+DSW_QUERY_NUMBER(moonPhase)
+
+DSW_QUERY_STEP(icon,        uint8_t)
+DSW_QUERY_STEP(precipType,  uint8_t)
+DSW_QUERY_STEP(windBearing, uint16_t)
+DSW_QUERY_STEP(sunriseTime, uint32_t)
+DSW_QUERY_STEP(sunsetTime,  uint32_t)
+
+// Summary Strings are returned as const char*
+template <class T, class = void> struct dsw_query_summary {
+  static const bool has = false;
+  static const char *get(const T *, int16_t, float) { return ""; }
+};
+template <class T> struct dsw_query_summary<T, decltype((void)std::declval<T &>().summary[0].c_str())> {
+  static const bool has = true;
+  static const char *get(const T *s, int16_t i, float) { return s->summary[i].c_str(); }
+};
+
+/***************************************************************************************
+** Function name:           dswFindTime
+** Description:             Element of s holding time t, -1 if none
+***************************************************************************************/
+// The elements are in time order, element i covers time[i] up to time[i + 1] and the
+// last one covers span seconds. f is set to the fraction of the way to the next element.
+template <class T>
+int16_t dswFindTime(const T *s, uint32_t t, uint32_t span, float *f = nullptr)
+{
+  if (f) *f = 0;
+  if (!s) return -1;
+
+  int16_t n = s->records;
+  if (n > (int16_t)T::size) n = T::size;
+  if (n == 0 || t < s->time[0]) return -1;
+
+  // Last element with time <= t
+  int16_t lo = 0, hi = n - 1;
+  while (lo < hi) {
+    int16_t mid = (lo + hi + 1) / 2;
+    if (s->time[mid] <= t) lo = mid;
+    else hi = mid - 1;
+  }
+
+  if (lo == n - 1) return (t - s->time[lo] < span) ? lo : -1;
+
+  if (f) *f = (float)(t - s->time[lo]) / (float)(s->time[lo + 1] - s->time[lo]);
+  return lo;
+}
+
+/***************************************************************************************
+** Description:   Query class, M, H and D are the minutely, hourly and daily struct types
+***************************************************************************************/
+#define DSW_QUERY_FLOAT(m)    float m(uint32_t t) { return find<float, dsw_query_##m>(t); }
+#define DSW_QUERY_VALUE(m, T) T m(uint32_t t) { return find<T, dsw_query_##m>(t); }
+
+template <class M = DSW_minutely, class H = DSW_hourly, class D = DSW_daily>
+class DSW_query {
+
+  public:
+    DSW_query(const M *minutely, const H *hourly, const D *daily)
+      : minutely(minutely), hourly(hourly), daily(daily), used(DSW_SECTIONS) { }
+
+    // Element of a section (DSW_MINUTELY, DSW_HOURLY or DSW_DAILY) holding time t, -1 if none
+    int16_t index(uint8_t section, uint32_t t) {
+      switch (section) {
+        case DSW_MINUTELY: return dswFindTime(minutely, t, DSW_MINUTELY_SPAN);
+        case DSW_HOURLY:   return dswFindTime(hourly,   t, DSW_HOURLY_SPAN);
+        case DSW_DAILY:    return dswFindTime(daily,    t, DSW_DAILY_SPAN);
+        default:           return -1;
+      }
+    }
+
+    // Section used by the last query, DSW_SECTIONS if no section held the time
+    uint8_t section() { return used; }
+
+    DSW_QUERY_FLOAT(precipIntensity)
+    DSW_QUERY_FLOAT(precipProbability)
+    DSW_QUERY_FLOAT(precipAccumulation)
+    DSW_QUERY_FLOAT(temperature)
+    DSW_QUERY_FLOAT(temperatureHigh)
+    DSW_QUERY_FLOAT(temperatureLow)
+    DSW_QUERY_FLOAT(humidity)
+    DSW_QUERY_FLOAT(pressure)
+    DSW_QUERY_FLOAT(windSpeed)
+    DSW_QUERY_FLOAT(windGust)
+    DSW_QUERY_FLOAT(cloudCover)
+    DSW_QUERY_FLOAT(moonPhase)
+
+    DSW_QUERY_VALUE(icon,        uint8_t)
+    DSW_QUERY_VALUE(precipType,  uint8_t)
+    DSW_QUERY_VALUE(windBearing, uint16_t)
+    DSW_QUERY_VALUE(sunriseTime, uint32_t)
+    DSW_QUERY_VALUE(sunsetTime,  uint32_t)
+
+    const char *summary(uint32_t t) {
+      const char *s = find<const char *, dsw_query_summary>(t);
+      return s ? s : "";
+    }
+
+  private:
+    // Try each section that has data point Q, finest first
+    template <class R, template <class, class = void> class Q>
+    R find(uint32_t t) {
+      R r = R();
+      if (search<Q>(minutely, t, DSW_MINUTELY_SPAN, DSW_MINUTELY, r, std::integral_constant<bool, Q<M>::has>()) ||
+          search<Q>(hourly,   t, DSW_HOURLY_SPAN,   DSW_HOURLY,   r, std::integral_constant<bool, Q<H>::has>()) ||
+          search<Q>(daily,    t, DSW_DAILY_SPAN,    DSW_DAILY,    r, std::integral_constant<bool, Q<D>::has>()))
+        return r;
+      used = DSW_SECTIONS;
+      return r;
+    }
+
+    // Sets r to the value of data point Q at time t if s holds t
+    template <template <class, class = void> class Q, class T, class R>
+    bool search(const T *s, uint32_t t, uint32_t span, uint8_t section, R &r, std::true_type) {
+      float f;
+      int16_t i = dswFindTime(s, t, span, &f);
+      if (i < 0) return false;
+      r = Q<T>::get(s, i, f);
+      used = section;
+      return true;
+    }
+
+    // Section does not have the data point
+    template <template <class, class = void> class Q, class T, class R>
+    bool search(const T *, uint32_t, uint32_t, uint8_t, R &, std::false_type) { return false; }
+
+    const M *minutely;
+    const H *hourly;
+    const D *daily;
+
+    uint8_t  used;     // Section of the last query
+};
+
+#endif
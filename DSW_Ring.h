@@ -0,0 +1,116 @@
+// Lock free byte ring and receive/parse pipeline for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// Normally the client read (with the TLS decrypt) and the JSON parse take turns on one
+// core. With a ring set the body is read on the calling task and passed through the ring
+// to a parse task on the other core, so the two overlap (ESP32 only):
+//
+//   DSW_ring_t<4096> ring;                     // 4 kbytes, normally a global
+//   dsw.setPipeline(&ring);
+//   ...
+//   dsw.getForecast(...);
+//   Serial.println(ring.peak());               // Most bytes the ring held
+//   Serial.println(ring.fullWaits());          // Times the reader waited for the parser
+//
+// When the ring is full the client is not read until the parser catches up, so the
+// server is held back by the TCP window instead of the data being buffered. The ring is
+// used by getForecast() and streamForecast(), beginForecast() and poll() parse on the
+// sketch task as before. If the parse task cannot be created the response is parsed on
+// the calling task.
+//
+// A DSW_ring is a single producer, single consumer queue. One task may call write(),
+// space(), waitForSpace() and finish(), one other task peek(), consume(), waitForData()
+// and close(). Each index is written by one side only, so no lock is needed.
+//
+// Define DSW_STD_THREAD to build this with std::thread instead of FreeRTOS, e.g. to test
+// it on a PC.
+
+#ifndef DSW_Ring_h
+#define DSW_Ring_h
+
+#if defined(ESP32) || defined(DSW_STD_THREAD)
+
+#define DSW_PIPELINE
+
+#include <atomic>
+
+#define DSW_PARSE_STACK    6144 // Bytes, JSON_Decoder and the callbacks
+#define DSW_PARSE_PRIORITY 1
+
+/***************************************************************************************
+** Description:   Non template part of the ring, the code is in DarkSkyWeather.cpp
+***************************************************************************************/
+class DSW_ring {
+
+  public:
+    void begin(); // Empty the ring and clear the counts, no task may be using it
+
+    // Producer
+    uint32_t space() const { return mask + 1 - (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire)); }
+    uint32_t write(const uint8_t *data, uint32_t count); // Returns the bytes that fitted
+    void     waitForSpace();                             // Let the consumer run, ring is full
+    void     finish() { ended.store(true, std::memory_order_release); } // No more writes
+
+    // Consumer
+    uint32_t peek(const uint8_t **data) const; // Contiguous bytes readable at *data
+    void     consume(uint32_t count) { tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+    void     waitForData();                    // Let the producer run, ring is empty
+    void     close() { shut.store(true, std::memory_order_release); } // Consumer has stopped
+
+    uint32_t available() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    bool     finished()  const { return ended.load(std::memory_order_acquire); }
+    bool     closed()    const { return shut.load(std::memory_order_acquire); }
+    uint32_t size()      const { return (uint32_t)mask + 1; }
+
+    static void pause(); // Give the other task a turn
+
+    // Counts since begin(), read them when the pipeline has stopped
+    uint32_t bytesWritten() const { return written; }
+    uint32_t peak()         const { return highWater; } // Most bytes held
+    uint32_t fullWaits()    const { return fullCount; }
+    uint32_t emptyWaits()   const { return emptyCount; }
+
+    DSW_ring(const DSW_ring &) = delete; // buffer points to the derived class
+    DSW_ring &operator=(const DSW_ring &) = delete;
+
+  protected:
+    DSW_ring(uint8_t *buffer, uint32_t size) : buffer(buffer), mask(size - 1) { begin(); }
+
+  private:
+    uint8_t  *buffer;
+    uint32_t  mask;      // Size - 1, the size is a power of 2
+
+    // Free running byte counts, the buffer position is the count & mask. head is only
+    // written by the producer and tail by the consumer
+    std::atomic<uint32_t> head { 0 };
+    std::atomic<uint32_t> tail { 0 };
+    std::atomic<bool>     ended { false };
+    std::atomic<bool>     shut { false };
+
+    uint32_t  written;    // Producer counts
+    uint32_t  highWater;
+    uint32_t  fullCount;
+    uint32_t  emptyCount; // Consumer count
+};
+
+// N bytes, a power of 2 from 256
+template <uint32_t N>
+class DSW_ring_t : public DSW_ring {
+  static_assert(N >= 256 && (N & (N - 1)) == 0, "Ring size must be a power of 2 from 256");
+  public:
+    DSW_ring_t() : DSW_ring(buffer, N) { }
+  private:
+    uint8_t buffer[N];
+};
+
+#else
+
+class DSW_ring; // Single core, setPipeline() is not available
+
+#endif // ESP32 or DSW_STD_THREAD
+
+#endif
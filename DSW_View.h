@@ -0,0 +1,165 @@
+// Lazy forecast views for the DarkSkyWeather library
+
+// Created by Bodmer 24/9/2018
+// This is a beta test version and is subject to change!
+
+// See license.txt in root folder of library
+
+// A view is an alternative to the DSW_minutely_t, DSW_hourly_t and DSW_daily_t structs.
+// While parsing, the value text of each data point is copied to a compact pool (no key
+// names, quotes or whitespace) with one offset per "data" array element. Nothing is
+// converted until the sketch calls an accessor, e.g. hourly->temperature(5), numeric
+// values are then decoded and held in a small cache. There are no Strings, text is
+// returned as a const char* pointing into the pool.
+
+// This saves CPU time and heap when many records are received but only a few of their
+// values are used, e.g. a display page showing 6 of 48 hours.
+
+// The view is passed to getForecast() in place of the struct:
+//
+//   DSW_hourly_view *hourly = new DSW_hourly_view;
+//   dsw.getForecast(current, nullptr, hourly, daily, api_key, ...);
+//   Serial.println(hourly->temperature(3));
+//
+// Template parameters: F data point mask as for the structs (e.g. DSW_HOURLY_ALL),
+// N "data" array elements kept, P pool size in bytes and C decoded values cached.
+// If P is too small, storing stops when it is full and overflow() is true.
+
+#ifndef DSW_View_h
+#define DSW_View_h
+
+#define DSW_VIEW_SCALARS 0xFFFE // Record index for the section values outside "data"
+#define DSW_VIEW_NONE    0xFFFF // Pool offset for a record with no values
+#define DSW_VIEW_END     0xFF   // Pool byte ending the values of a record
+
+// Typical pool bytes per "data" array element with all data points selected
+#define DSW_MINUTELY_RECORD 32
+#define DSW_HOURLY_RECORD   80
+#define DSW_DAILY_RECORD    160
+#define DSW_SCALARS_RECORD  128 // Section overall summary etc
+
+typedef struct dsw_view_cache_t {
+  uint16_t record;  // Record index, DSW_VIEW_NONE if unused
+  uint8_t  field;   // dsw_field_t
+  uint32_t value;   // Decoded value, float bits for a float
+} dsw_view_cache_t;
+
+/***************************************************************************************
+** Description:   Non template part of all views, the code is in DarkSkyWeather.cpp
+***************************************************************************************/
+class DSW_view {
+
+  public:
+    uint16_t count()    { return records; } // Data array elements with values stored
+    uint16_t poolUsed() { return used; }    // Pool bytes used by the last response
+    uint16_t poolSize() { return poolBytes; }
+    bool     overflow() { return dropped; } // true if values were dropped, pool too small
+
+    DSW_view(const DSW_view &) = delete;    // The pointers below are to the derived class
+    DSW_view &operator=(const DSW_view &) = delete;
+
+  protected:
+    DSW_view(uint8_t section, char *pool, uint16_t size, uint16_t *record, uint16_t n,
+             dsw_view_cache_t *cache, uint8_t cacheSize)
+      : section(section), pool(pool), poolBytes(size), record(record), n(n),
+        cache(cache), cacheSize(cacheSize) { start(); }
+
+    // Clear the view and point the binding at it, called via getForecast()
+    void bind(dsw_binding_t &b, uint32_t fields);
+
+    // Text of a field, "" if not received
+    const char *text(uint16_t i, uint8_t field);
+
+    // Decode a field on first read, later reads come from the cache
+    uint32_t decode(uint16_t i, uint8_t field, uint8_t kind);
+
+    static float toFloat(uint32_t u) { float f; memcpy(&f, &u, sizeof(f)); return f; }
+
+  private:
+    friend class DS_Weather;
+
+    void start();
+    void store(uint16_t i, uint8_t field, const char *val); // Called by DS_Weather::value()
+    const char *find(uint16_t i, uint8_t field);            // nullptr if not received
+
+    uint8_t           section;    // dsw_section_t
+    char             *pool;       // Value text, each value is a field byte then the text
+    uint16_t          poolBytes;  // Pool size
+    uint16_t          used;       // Pool bytes used
+    uint16_t         *record;     // Pool offset of each record's values
+    uint16_t          n;          // Records that can be stored
+    uint16_t          records;    // Records stored
+    uint16_t          scalars;    // Pool offset of the section values outside "data"
+    uint16_t          openRecord; // Record being stored
+    bool              dropped;    // Pool overflow
+
+    dsw_view_cache_t *cache;
+    uint8_t           cacheSize;
+    uint8_t           cacheNext;  // Next entry to replace
+};
+
+/***************************************************************************************
+** Description:   Accessors generated from the data point lists
+***************************************************************************************/
+#define DSW_VIEW_GET_TEXT(m, f, arg, i)  const char *m(arg) { return text(i, f); }
+#define DSW_VIEW_GET_UNIX(m, f, arg, i)  uint32_t m(arg) { return decode(i, f, DSW_KIND_UNIX); }
+#define DSW_VIEW_GET_U16(m, f, arg, i)   uint16_t m(arg) { return decode(i, f, DSW_KIND_U16); }
+#define DSW_VIEW_GET_PCT(m, f, arg, i)   uint8_t  m(arg) { return decode(i, f, DSW_KIND_PCT); }
+#define DSW_VIEW_GET_ICON(m, f, arg, i)  uint8_t  m(arg) { return decode(i, f, DSW_KIND_ICON); }
+#define DSW_VIEW_GET_PTYPE(m, f, arg, i) uint8_t  m(arg) { return decode(i, f, DSW_KIND_PTYPE); }
+#define DSW_VIEW_GET_FLOAT(m, f, arg, i) float    m(arg) { return toFloat(decode(i, f, DSW_KIND_FLOAT)); }
+#define DSW_VIEW_GET_TEMP(m, f, arg, i)  DSW_VIEW_GET_FLOAT(m, f, arg, i)
+#define DSW_VIEW_GET_PRESS(m, f, arg, i) DSW_VIEW_GET_FLOAT(m, f, arg, i)
+#define DSW_VIEW_GET_RATE(m, f, arg, i)  DSW_VIEW_GET_FLOAT(m, f, arg, i)
+#define DSW_VIEW_GET_ACCUM(m, f, arg, i) DSW_VIEW_GET_FLOAT(m, f, arg, i)
+#define DSW_VIEW_GET_SPEED(m, f, arg, i) DSW_VIEW_GET_FLOAT(m, f, arg, i)
+
+// Section values have no index e.g. overallSummary(), array values do e.g. time(3)
+#define DSW_VIEW_SCALAR(S, s, m, k, kind) DSW_VIEW_GET_##kind(m, DSW_FIELD_##s##_##m, , DSW_VIEW_SCALARS)
+#define DSW_VIEW_ARRAY(S, s, m, k, kind)  DSW_VIEW_GET_##kind(m, DSW_FIELD_##s##_##m, uint16_t i, i)
+
+// Storage and constructor common to the view templates
+#define DSW_VIEW_STORAGE(SECTION, name)                                                 \
+  public:                                                                               \
+    name() : DSW_view(SECTION, pool, P, record, N, cache, C) { }                        \
+    static const uint32_t fields = F;                                                   \
+    static const uint16_t size = N;                                                     \
+    void dswBind(dsw_binding_t &b) { bind(b, F); }                                      \
+  private:                                                                              \
+    char             pool[P];                                                           \
+    uint16_t         record[N];                                                         \
+    dsw_view_cache_t cache[C];                                                          \
+  public:
+
+/***************************************************************************************
+** Description:   View templates, one per section with "data" arrays
+***************************************************************************************/
+template <uint32_t F = DSW_MINUTELY_ALL, uint16_t N = MAX_MINUTES,
+          uint16_t P = N * DSW_MINUTELY_RECORD + DSW_SCALARS_RECORD, uint8_t C = 8>
+class DSW_minutely_view_t : public DSW_view {
+  DSW_VIEW_STORAGE(DSW_MINUTELY, DSW_minutely_view_t)
+  DSW_MINUTELY_SCALARS(DSW_VIEW_SCALAR, MINUTELY, minutely)
+  DSW_MINUTELY_ARRAYS(DSW_VIEW_ARRAY, MINUTELY, minutely)
+};
+
+template <uint32_t F = DSW_HOURLY_ALL, uint16_t N = MAX_HOURS,
+          uint16_t P = N * DSW_HOURLY_RECORD + DSW_SCALARS_RECORD, uint8_t C = 8>
+class DSW_hourly_view_t : public DSW_view {
+  DSW_VIEW_STORAGE(DSW_HOURLY, DSW_hourly_view_t)
+  DSW_HOURLY_SCALARS(DSW_VIEW_SCALAR, HOURLY, hourly)
+  DSW_HOURLY_ARRAYS(DSW_VIEW_ARRAY, HOURLY, hourly)
+};
+
+template <uint32_t F = DSW_DAILY_ALL, uint16_t N = MAX_DAYS,
+          uint16_t P = N * DSW_DAILY_RECORD + DSW_SCALARS_RECORD, uint8_t C = 8>
+class DSW_daily_view_t : public DSW_view {
+  DSW_VIEW_STORAGE(DSW_DAILY, DSW_daily_view_t)
+  DSW_DAILY_SCALARS(DSW_VIEW_SCALAR, DAILY, daily)
+  DSW_DAILY_ARRAYS(DSW_VIEW_ARRAY, DAILY, daily)
+};
+
+typedef DSW_minutely_view_t<> DSW_minutely_view;
+typedef DSW_hourly_view_t<>   DSW_hourly_view;
+typedef DSW_daily_view_t<>    DSW_daily_view;
+
+#endif
@@ -23,779 +23,3059 @@
 #include <JSON_Decoder.h>
 
 #include "DarkSkyWeather.h"
+#include "DSW_Background.h"
+#include "DSW_Pool.h"
 
+// The built in parser calls the DS_Weather callbacks directly, JSON_Decoder calls them
+// through the JsonListener virtual functions
+#ifdef USE_JSON_DECODER
+  typedef JSON_Decoder dsw_parser_t;
+#else
+  typedef DSW_Parser<DS_Weather> dsw_parser_t;
+#endif
 
-/***************************************************************************************
-** Function name:           getForecast
-** Description:             Setup the weather forecast request from darksky.net
-***************************************************************************************/
-// The structures etc are created by the sketch and passed to this function.
-// Pass a nullptr for current, hourly or daily pointers to exclude in response.
-// Provided for backwards compatibility prior to adding minutely data request
-bool DS_Weather::getForecast(DSW_current *current, DSW_hourly *hourly, DSW_daily *daily,
-                             String api_key, String latitude, String longitude,
-                             String units, String language) {
+// Must use namespace:: to select BearSSL on the ESP8266
+#if defined(ESP32) || defined(AXTLS)
+  typedef WiFiClientSecure dsw_client_t;
+#else
+  typedef BearSSL::WiFiClientSecure dsw_client_t;
+  #ifdef DSW_KEEP_ALIVE
+    #define DSW_TLS_SESSION // BearSSL can resume a TLS session on a new socket
+  #endif
+#endif
+
+// The secure client, kept between requests if DSW_KEEP_ALIVE is defined
+struct DSW_client {
+  dsw_client_t tls;
+#ifdef DSW_TLS_SESSION
+  BearSSL::Session session; // Filled by the handshake, offered by the next connect()
+  bool resume = false;      // true once the session holds a handshake
+#endif
+};
+
+// State of a request started by beginForecast()
+struct DSW_fetch {
+  String       url;
+  dsw_parser_t parser;
+  uint32_t     start;   // millis() at beginForecast()
+  uint8_t      attempt; // Retries after a stale kept alive socket or a small window
+};
 
-  return getForecast(current, nullptr, hourly, daily, api_key, latitude, longitude, units, language);
-}
 
 /***************************************************************************************
-** Function name:           getForecast
+** Function name:           requestForecast
 ** Description:             Setup the weather forecast request from darksky.net
 ***************************************************************************************/
-// The structures etc are created by the sketch and passed to this function.
-// Pass a nullptr for current, minutely, hourly or daily pointers to exclude in response.
-bool DS_Weather::getForecast(DSW_current *current, DSW_minutely *minutely, DSW_hourly *hourly, DSW_daily *daily,
-                             String api_key, String latitude, String longitude,
-                             String units, String language) {
+// The structures etc are created by the sketch and passed to getForecast(), which binds
+// their members. Pass a nullptr for current, minutely, hourly or daily pointers to
+// exclude in response, a struct with no data points selected is also excluded.
+bool DS_Weather::requestForecast(String api_key, String latitude, String longitude,
+                                 String units, String language) {
 
-  data_set = "";
-  minutely_index = 0;
-  hourly_index = 0;
-  daily_index = 0;
+  // Send GET request and feed the parser
+  bool result = parseRequest(forecastUrl(api_key, latitude, longitude, units, language));
+  if (result) addSnapshot();
 
-  // Local copies of structure pointers, the structures are filled during parsing
-  this->current  = current;
-  this->minutely = minutely;
-  this->hourly   = hourly;
-  this->daily    = daily;
+  // Clear the binding to prevent crashes
+  memset(&binding, 0, sizeof(binding));
 
-#if defined (MINIMISE_DATA_POINTS) // If defined in DarSkyWeather library "User_Setup.h"
-   hourly = nullptr;
-#endif
+  return result;
+}
+
+/***************************************************************************************
+** Function name:           forecastUrl
+** Description:             Build the request url for the bound data sets
+***************************************************************************************/
+String DS_Weather::forecastUrl(String api_key, String latitude, String longitude,
+                               String units, String language) {
 
   // Exclude some info by passing fn a NULL pointer to reduce memory needed
   String exclude = "";
-  if (!current)  exclude += "currently,";   // summary, then current weather
-  if (!minutely) exclude += "minutely,";    // summary, rain predictions every minute for next hour
-  if (!hourly)   exclude += "hourly,";      // summary, then weather every hour for 48 hours
-  if (!daily)    exclude += "daily,";       // summary, then daily detailed weather for one week (7 days)
+  if (!binding.fields[DSW_CURRENT])  exclude += "currently,";   // summary, then current weather
+  if (!binding.fields[DSW_MINUTELY]) exclude += "minutely,";    // summary, rain predictions every minute for next hour
+  if (!binding.fields[DSW_HOURLY])   exclude += "hourly,";      // summary, then weather every hour for 48 hours
+  if (!binding.fields[DSW_DAILY])    exclude += "daily,";       // summary, then daily detailed weather for one week (7 days)
 
   exclude += "alerts,";   // special warnings, typically none
   exclude += "flags";     // misc info
 
-  String url = "https://api.darksky.net/forecast/" + api_key + "/"
-               + latitude + "," + longitude + "?exclude=" + exclude
-               + "&units=" + units + "&lang=" + language;
-
-  // Send GET request and feed the parser
-  bool result = parseRequest(url);
-
-  // Null out pointers to prevent crashes
-  this->current  = nullptr;
-  this->minutely = nullptr;
-  this->hourly   = nullptr;
-  this->daily    = nullptr;
-
-  return result;
+  return "https://api.darksky.net/forecast/" + api_key + "/"
+         + latitude + "," + longitude + "?exclude=" + exclude
+         + "&units=" + units + "&lang=" + language;
 }
 
-#ifdef ESP32 // Decide if ESP32 or ESP8266 parseRequest available
-
 /***************************************************************************************
-** Function name:           parseRequest (for ESP32)
-** Description:             Fetches the JSON message and feeds to the parser
+** Function name:           beginRequest
+** Description:             Start a non-blocking forecast request, see poll()
 ***************************************************************************************/
-bool DS_Weather::parseRequest(String url) {
+bool DS_Weather::beginRequest(String api_key, String latitude, String longitude,
+                              String units, String language) {
 
-  uint32_t dt = millis();
+  fetch = new DSW_fetch;
+  fetch->url = forecastUrl(api_key, latitude, longitude, units, language);
+  fetch->parser.setListener(this);
+  fetch->start = millis();
+  fetch->attempt = 0;
 
-  // This certificate will expire in June 2019, but we can ignore it at line 111
-  const char* dsw_ca_cert = \
-  "-----BEGIN CERTIFICATE-----\n" \
-  "MIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\n" \
-  "ADA5MQswCQYDVQQGEwJVUzEPMA0GA1UEChMGQW1hem9uMRkwFwYDVQQDExBBbWF6\n" \
-  "b24gUm9vdCBDQSAxMB4XDTE1MDUyNjAwMDAwMFoXDTM4MDExNzAwMDAwMFowOTEL\n" \
-  "MAkGA1UEBhMCVVMxDzANBgNVBAoTBkFtYXpvbjEZMBcGA1UEAxMQQW1hem9uIFJv\n" \
-  "b3QgQ0EgMTCCASIwDQYJKoZIhvcNAQEBBQADggEPADCCAQoCggEBALJ4gHHKeNXj\n" \
-  "ca9HgFB0fW7Y14h29Jlo91ghYPl0hAEvrAIthtOgQ3pOsqTQNroBvo3bSMgHFzZM\n" \
-  "9O6II8c+6zf1tRn4SWiw3te5djgdYZ6k/oI2peVKVuRF4fn9tBb6dNqcmzU5L/qw\n" \
-  "IFAGbHrQgLKm+a/sRxmPUDgH3KKHOVj4utWp+UhnMJbulHheb4mjUcAwhmahRWa6\n" \
-  "VOujw5H5SNz/0egwLX0tdHA114gk957EWW67c4cX8jJGKLhD+rcdqsq08p8kDi1L\n" \
-  "93FcXmn/6pUCyziKrlA4b9v7LWIbxcceVOF34GfID5yHI9Y/QCB/IIDEgEw+OyQm\n" \
-  "jgSubJrIqg0CAwEAAaNCMEAwDwYDVR0TAQH/BAUwAwEB/zAOBgNVHQ8BAf8EBAMC\n" \
-  "AYYwHQYDVR0OBBYEFIQYzIU07LwMlJQuCFmcx7IQTgoIMA0GCSqGSIb3DQEBCwUA\n" \
-  "A4IBAQCY8jdaQZChGsV2USggNiMOruYou6r4lK5IpDB/G/wkjUu0yKGX9rbxenDI\n" \
-  "U5PMCCjjmCXPI6T53iHTfIUJrU6adTrCC2qJeHZERxhlbI1Bjjt/msv0tadQ1wUs\n" \
-  "N+gDS63pYaACbvXy8MWy7Vu33PqUXHeeE6V/Uq2V8viTO96LXFvKWlJbYK8U90vv\n" \
-  "o/ufQJVtMVT8QtPHRh8jrdkPSHCa2XV4cdFyQzR1bldZwgJcJmApzyMZFo6IQ6XU\n" \
-  "5MsI+yMRQ+hDKXJioaldXgjUkK642M4UwtBV8ob2xJNDd2ZhwLnoQdeXeGADbkpy\n" \
-  "rqXRfboQnoZsG4q5WTP468SQvvG5\n" \
-  "-----END CERTIFICATE-----\n";
+  // The client is kept while the fetch is in progress, and after it if DSW_KEEP_ALIVE
+  if (!client) client = new DSW_client;
+  setupClient(*client);
 
-  WiFiClientSecure client;
+  fetchState = DSW_FETCH_CONNECT;
+  return true;
+}
 
-  
-  //client.setCACert(dsw_ca_cert);  // Comment out to stop certificate check
+/***************************************************************************************
+** Function name:           poll
+** Description:             Do the next step of the request started by beginForecast()
+***************************************************************************************/
+// Each call connects (or reuses the kept alive socket) and sends the request, or reads
+// and parses one block of the response. The connect step blocks for the TLS handshake,
+// the client library has no non-blocking handshake.
+uint8_t DS_Weather::poll()
+{
+  if (!fetch) return fetchState;
 
-  JSON_Decoder parser;
-  parser.setListener(this);
+  if (fetchState == DSW_FETCH_CONNECT)
+  {
+    if (startRequest(*client, fetch->url)) fetchState = DSW_FETCH_HEADER;
+    else endFetch(false);
+    return fetchState;
+  }
 
-  const char*  host = "api.darksky.net";
+  int8_t state = readBlock(client->tls, fetch->parser);
+  if (headerDone) fetchState = DSW_FETCH_BODY;
+  if (state == 0) return fetchState;
 
-  if (!client.connect(host, 443))
+  if (endRequest(*client, state > 0) && fetch->attempt++ < DSW_RETRIES)
   {
-    Serial.println("Connection failed.");
-    return false;
+    fetch->parser.reset();
+    fetchState = DSW_FETCH_CONNECT;
+    return fetchState;
   }
 
-  uint32_t timeout = millis();
-  char c = 0;
-  int ccount = 0;
-  uint32_t readCount = 0;
-  parseOK = false;
-
-  // Send GET request
-  Serial.println("\nSending GET request to api.darksky.net...");
-  client.print(String("GET ") + url + " HTTP/1.1\r\n" + "Host: " + host + "\r\n" + "Connection: close\r\n\r\n");
+  endFetch(state > 0 && parseOK);
+  return fetchState;
+}
 
-  // Pull out any header, X-Forecast-API-Calls: reports current daily API call count
-  while (client.connected())
-  {
-    String line = client.readStringUntil('\n');
-    if (line == "\r") {
-      Serial.println("Header end found");
-      break;
-    }
+/***************************************************************************************
+** Function name:           cancelForecast
+** Description:             Stop the request started by beginForecast()
+***************************************************************************************/
+void DS_Weather::cancelForecast()
+{
+  if (!fetch) return;
 
-#ifdef SHOW_HEADER
-    Serial.println(line);
-#else
-    // Show the API call count
-    if (line.indexOf("X-Forecast-API-Calls") >= 0) Serial.println(line);
-#endif
+  // The rest of the response would be read by the next request
+  client->tls.stop();
+  endFetch(false);
+}
 
-    if ((millis() - timeout) > 5000UL)
-    {
-      Serial.println ("HTTP header timeout");
-      client.stop();
-      return false;
-    }
-  }
+/***************************************************************************************
+** Function name:           endFetch
+** Description:             Finish the request started by beginForecast()
+***************************************************************************************/
+void DS_Weather::endFetch(bool result)
+{
+  Serial.println("");
+  Serial.print("Done in "); Serial.print(millis() - fetch->start); Serial.println(" ms\n");
 
-  Serial.println("\nParsing JSON");
+  fetch->parser.reset();
+  delete fetch;
+  fetch = nullptr;
 
-  // Parse the JSON data, available() includes yields
-  while ( client.available() > 0 || client.connected())
-  {
-    while(client.available() > 0)
-    {
-      c = client.read();
-      parser.parse(c);
-#ifdef SHOW_JSON
-      if (c == '{' || c == '[' || c == '}' || c == ']') Serial.println();
-      Serial.print(c); if (ccount++ > 100 && c == ',') {ccount = 0; Serial.println();}
+#ifndef DSW_KEEP_ALIVE
+  closeConnection();
 #endif
 
-      if ((millis() - timeout) > 8000UL)
-      {
-        Serial.println ("JSON parse client timeout");
-        parser.reset();
-        client.stop();
-        return false;
-      }
-      yield();
-    }
-  }
-
-  Serial.println("");
-  Serial.print("Done in "); Serial.print(millis()-dt); Serial.println(" ms\n");
+  if (result) addSnapshot();
 
-  parser.reset();
+  // Clear the binding to prevent crashes
+  memset(&binding, 0, sizeof(binding));
 
-  client.stop();
-  
-  // A message has been parsed but the datapoint correctness is unknown
-  return parseOK;
+  fetchState = result ? DSW_FETCH_DONE : DSW_FETCH_FAILED;
 }
 
-#else // ESP8266 version
-
 /***************************************************************************************
-** Function name:           parseRequest (for ESP8266)
-** Description:             Fetches the JSON message and feeds to the parser
+** Function name:           closeConnection
+** Description:             Close the kept alive connection and free the client
 ***************************************************************************************/
-bool DS_Weather::parseRequest(String url) {
-
-  uint32_t dt = millis();
+void DS_Weather::closeConnection()
+{
+  if (!client) return;
 
-  // SHA1 certificate fingerprint
-  #if defined(AXTLS)
-    const char* fingerprint = "EB:C2:67:D1:B1:C6:77:90:51:C1:4A:0A:BA:83:E1:F0:6D:73:DD:B8";
-    WiFiClientSecure client;
-  #else
-    // Must use namespace:: to select BearSSL
-    BearSSL::WiFiClientSecure client;
+  client->tls.stop();
+  delete client;
+  client = nullptr;
+}
 
-    #ifdef SECURE_SSL
-      // BearSSL requires a different fingerprint format and setFingerprint() must be called
-      const uint8_t fp[20] = {0xEB,0xC2,0x67,0xD1,0xB1,0xC6,0x77,0x90,0x51,0xC1,0x4A,0x0A,0xBA,0x83,0xE1,0xF0,0x6D,0x73,0xDD,0xB8};
-      client.setFingerprint(fp);
-    #else
-      client.setInsecure();
-    #endif
-  #endif
+/***************************************************************************************
+** Function name:           openConnection
+** Description:             Connect a new socket to the server
+***************************************************************************************/
+bool DS_Weather::openConnection(DSW_client &link, const char *host)
+{
+  uint32_t dt = millis();
 
-  JSON_Decoder parser;
-  parser.setListener(this);
+  connection.type = DSW_CONNECT_FULL;
+  connection.requests = 0;
 
-  const char*  host = "api.darksky.net";
+#ifdef DSW_TLS_SESSION
+  // An abbreviated handshake is done if the server still holds the session
+  if (link.resume) connection.type = DSW_CONNECT_RESUMED;
+  link.tls.setSession(&link.session);
+#endif
 
-  if (!client.connect(host, 443))
+  if (!link.tls.connect(host, 443))
   {
     Serial.println("Connection failed.");
+    connection.type = DSW_CONNECT_NONE;
     return false;
   }
 
 #if defined(AXTLS)
+  // SHA1 certificate fingerprint
+  const char* fingerprint = "EB:C2:67:D1:B1:C6:77:90:51:C1:4A:0A:BA:83:E1:F0:6D:73:DD:B8";
+
   // BearSSL does not support verify() and always returns false.
-  if (client.verify(fingerprint, host))
+  if (link.tls.verify(fingerprint, host))
   {
     Serial.println("Certificate OK");
   }
   else
   {
       Serial.println("Bad certificate");
-      client.stop();
+      link.tls.stop();
+      connection.type = DSW_CONNECT_NONE;
       return false;
   }
 #endif
 
-  uint32_t timeout = millis();
-  char c = 0;
-  int ccount = 0;
-  uint32_t readCount = 0;
-  parseOK = false;
-
-  // Send GET request
-  Serial.println("Sending GET request to api.darksky.net...");
-  client.print(String("GET ") + url + " HTTP/1.1\r\n" + "Host: " + host + "\r\n" + "Connection: close\r\n\r\n");
+#ifdef DSW_TLS_SESSION
+  link.resume = true;
+#endif
 
-  // Pull out any header, X-Forecast-API-Calls: reports current daily API call count
-  while (client.available() || client.connected())
-  {
-    String line = client.readStringUntil('\n');
-    if (line == "\r") {
-      Serial.println("Header end found");
-      break;
-    }
+  connection.connectTime = millis() - dt;
+  return true;
+}
 
-#ifdef SHOW_HEADER
-    Serial.println(line);
-#else
-    // Show the API call count
-    if (line.indexOf("X-Forecast-API-Calls") >= 0) Serial.println(line);
-#endif
+/***************************************************************************************
+** Function name:           startRequest
+** Description:             Connect (or reuse the kept alive socket) and send the GET request
+***************************************************************************************/
+bool DS_Weather::startRequest(DSW_client &link, const String &url)
+{
+  const char*  host = "api.darksky.net";
 
-    if ((millis() - timeout) > 5000UL)
-    {
-      Serial.println ("HTTP header timeout");
-      client.stop();
-      return false;
-    }
+  if (link.tls.connected())
+  {
+    connection.type = DSW_CONNECT_REUSED;
+    connection.connectTime = 0;
   }
-
-  Serial.println("Parsing JSON");
-  
-  // Parse the JSON data, available() includes yields
-  while (client.available() || client.connected())
+  else
   {
-    while (client.available())
-    {
-      c = client.read();
-      parser.parse(c);
-  #ifdef SHOW_JSON
-      if (c == '{' || c == '[' || c == '}' || c == ']') Serial.println();
-      Serial.print(c); if (ccount++ > 100 && c == ',') {ccount = 0; Serial.println();}
-  #endif
-    }
-
-    if ((millis() - timeout) > 8000UL)
-    {
-      Serial.println ("JSON client timeout");
-      parser.reset();
-      client.stop();
-      return false;
-    }
+    link.tls.stop();
+    if (!openConnection(link, host)) return false;
   }
 
-  Serial.println("");
-  Serial.print("Done in "); Serial.print(millis()-dt); Serial.println(" ms\n");
+  connection.requests++;
 
-  parser.reset();
+  parseOK = false;
+  dataComplete = false;
 
-  client.stop();
-  
-  // A message has been parsed without error but the datapoint correctness is unknown
-  return parseOK;
-}
+  // Send GET request
+  Serial.println("\nSending GET request to api.darksky.net...");
+  String request = String("GET ") + url + " HTTP/1.1\r\n" + "Host: " + host + "\r\n";
+  gzipRequested = inflater && !inflateOff;
+  if (gzipRequested) request += "Accept-Encoding: gzip, deflate\r\n";
+#ifdef DSW_KEEP_ALIVE
+  request += "Connection: keep-alive\r\n\r\n";
+#else
+  request += "Connection: close\r\n\r\n";
+#endif
+  link.tls.print(request);
 
-#endif // ESP32 or ESP8266 parseRequest
+  headerStart();
+  return true;
+}
 
 /***************************************************************************************
-** Function name:           key etc
-** Description:             These functions are called while parsing the JSON message
+** Function name:           endRequest
+** Description:             Close the socket unless it can be kept, true to retry
 ***************************************************************************************/
-void DS_Weather::key(const char *key) {
-
-  currentKey = key;
-
-#ifdef SHOW_CALLBACK
-  Serial.print("\n>>> Key >>>" + (String)key);
+// The socket is kept for the next request only if the whole response has been read and
+// the server has not asked to close it. The server may close a kept alive socket while
+// the request is sent, then nothing is received and the request is sent again on a new
+// socket. A gzip response that needs a larger window than the inflater has is asked for
+// again uncompressed.
+bool DS_Weather::endRequest(DSW_client &link, bool result)
+{
+#ifdef DSW_KEEP_ALIVE
+  if (!result || header.close || !bodyEnd()) link.tls.stop();
+#else
+  link.tls.stop();
 #endif
-}
 
-void DS_Weather::startDocument() {
+  if (!result && gzipRequested && inflateOff)
+  {
+    Serial.println("Inflate window too small, requesting uncompressed response");
+    return true;
+  }
 
-  currentParent = currentKey = "";
-  objectLevel = 0;
-  valuePath = "";
-  arrayIndex = 0;
-  parseOK = true;
+  // Otherwise only a stale kept alive socket is retried
+  if (result || header.status || connection.type != DSW_CONNECT_REUSED) return false;
 
-#ifdef SHOW_CALLBACK
-  Serial.print("\n>>> Start document >>>");
-#endif
+  Serial.println("Kept alive connection closed by server, reconnecting");
+  return true;
 }
 
-void DS_Weather::endDocument() {
+/***************************************************************************************
+** Function name:           sendRequest
+** Description:             Send the GET request and read the response
+***************************************************************************************/
+template <class P>
+bool DS_Weather::sendRequest(DSW_client &link, P &parser, const String &url)
+{
+  for (uint8_t attempt = 0; attempt <= DSW_RETRIES; attempt++)
+  {
+    if (!startRequest(link, url)) return false;
 
-  currentParent = currentKey = "";
-  objectLevel = 0;
-  valuePath = "";
-  arrayIndex = 0;
+    // Check the response header and parse the JSON message
+    bool result = readResponse(link.tls, parser);
 
-#ifdef SHOW_CALLBACK
-  Serial.print("\n<<< End document <<<");
-#endif
-}
+    if (!endRequest(link, result)) return result;
+    parser.reset();
+  }
 
-void DS_Weather::startObject() {
+  return false;
+}
 
-  currentParent = currentKey;
-  objectLevel++;
+/***************************************************************************************
+** Function name:           readResponse
+** Description:             Check the response header then feed the body to the parser
+***************************************************************************************/
+// Returns false on a timeout or if the HTTP status is not 200 (nothing is parsed then)
+template <class T, class P>
+bool DS_Weather::readResponse(T &client, P &parser)
+{
+  int8_t state = 0;
 
-#ifdef SHOW_CALLBACK
-  Serial.print("\n>>> Start object level:" + (String) objectLevel + " index:" + (String) arrayIndex +" >>>");
+#ifdef DSW_PIPELINE
+  if (ring) state = pipeResponse(client, parser);
 #endif
-}
-
-void DS_Weather::endObject() {
 
-  currentParent = "";
-  arrayIndex++;
-  objectLevel--;
+  // Parse the JSON data in blocks, the timeout check and yield are done once per block
+  while (!state)
+  {
+    state = readBlock(client, parser);
+    if (!state) yield();
+  }
 
-#ifdef SHOW_CALLBACK
-  Serial.print("\n<<< End object <<<");
-#endif
+  return state > 0;
 }
 
-void DS_Weather::startArray() {
+/***************************************************************************************
+** Function name:           readBlock
+** Description:             Read and parse one block, 0 if there is more to read
+***************************************************************************************/
+// The client is read in blocks into rxBuffer, the header scanner takes bytes from a block
+// until the blank line ending the header and the rest of the block goes to the parser,
+// after the chunk framing is removed if the body is chunked. Returns 1 at the end of the
+// body, or as soon as all the requested data has been parsed, and -1 on an error.
+template <class T, class P>
+int8_t DS_Weather::readBlock(T &client, P &parser)
+{
+  if ( !(client.available() > 0 || client.connected()) || bodyEnd()) return endResponse();
 
-  arrayIndex  = 0;
-  valuePath = currentParent + "/" + currentKey; // aka = current Object, e.g. "daily:data"
+  int count = client.available();
+  if (count > 0)
+  {
+    if (count > DSW_BUFFER_SIZE) count = DSW_BUFFER_SIZE;
+    if (bodyRemaining > 0 && count > bodyRemaining) count = bodyRemaining;
+    count = client.read(rxBuffer, count);
+    if (count > 0) received += count;
 
-#ifdef SHOW_CALLBACK
-  Serial.print("\n>>> Start array " + valuePath + "/" + (String) arrayIndex +" >>>");
-#endif
-}
+    int used = 0;
+    if (count > 0 && !headerDone)
+    {
+      used = scanHeader(rxBuffer, count);
+      if (headerDone)
+      {
+        if (header.apiCalls >= 0)
+        {
+          Serial.print("X-Forecast-API-Calls: "); Serial.println(header.apiCalls);
+        }
+
+        // Fail fast, an error response body is not a forecast
+        if (header.status != 200)
+        {
+          Serial.print("HTTP status "); Serial.println(header.status);
+          return -1;
+        }
+
+        // A compressed body needs the inflater it was requested for
+        compressed = header.encoding != DSW_ENCODING_IDENTITY;
+        if (compressed && (!inflater || header.encoding == DSW_ENCODING_OTHER))
+        {
+          Serial.println("Unsupported Content-Encoding");
+          return -1;
+        }
+        if (compressed) inflater->begin();
+
+        if (!header.chunked) bodyRemaining = header.contentLength;
+        Serial.println("Parsing JSON");
+      }
+    }
 
-void DS_Weather::endArray() {
+    if (count > used)
+    {
+      uint8_t *body = rxBuffer + used;
+      int length = count - used;
 
-  valuePath = "";
+      if (bodyRemaining > 0) bodyRemaining -= length;
+      if (header.chunked) length = dechunk(body, length);
 
-#ifdef SHOW_CALLBACK
-  Serial.print("\n<<< End array <<<");
+      if (length > 0 && !draining)
+      {
+        if (!compressed) parseBlock(parser, body, length);
+        else if (!inflateBlock(parser, body, length))
+        {
+          Serial.print("Inflate error "); Serial.println(inflater->error());
+
+          // Stop asking for gzip, the sketch can set a larger window
+          if (inflater->error() == DSW_INFLATE_WINDOW) inflateOff = true;
+          return -1;
+        }
+      }
+    }
+  }
+
+  if (dataComplete && !draining)
+  {
+    Serial.println("All requested data received");
+#ifdef DSW_KEEP_ALIVE
+    // The rest of the body is read (not parsed) so the socket can be reused, unless
+    // the server closes it anyway or the end of the body is not known
+    if (header.close || (!header.chunked && header.contentLength < 0)) return endResponse();
+    draining = true;
+#else
+    return endResponse();
 #endif
-}
+  }
 
-void DS_Weather::whitespace(char c) {
-}
+  if (!headerDone && (millis() - responseStart) > 5000UL)
+  {
+    Serial.println ("HTTP header timeout");
+    return -1;
+  }
 
-void DS_Weather::error( const char *message ) {
-  Serial.print("\nParse error message: ");
-  Serial.print(message);
-  parseOK = false;
+  if ((millis() - responseStart) > 8000UL)
+  {
+    if (draining) return endResponse(); // The socket is not reused
+
+    Serial.println ("JSON parse client timeout");
+    return -1;
+  }
+
+  return 0;
 }
 
+#ifdef DSW_PIPELINE
 /***************************************************************************************
-** Function name:           iconIndex
-** Description:             Convert the icon name to an array index to save memory
+** Function name:           pipeResponse
+** Description:             Read the body into the ring while the parse task drains it
 ***************************************************************************************/
-uint8_t DS_Weather::iconIndex(const char *val)
+// The header and the start of the body are handled by readBlock() on this task, then the
+// parse task is started. The parser, the structs and dataComplete belong to the parse
+// task until it closes the ring, so this task only reads them after that.
+template <class T, class P>
+int8_t DS_Weather::pipeResponse(T &client, P &parser)
 {
-  if (*val == 0) return MAX_ICON_INDEX; // null so return index for none
+  int8_t state;
+  while (!(state = readBlock(client, parser)) && !headerDone) yield();
+  if (state || draining) return state;
 
-  uint8_t i = 0;
-  for( i = 0; i <= MAX_ICON_INDEX; i++)
+  ring->begin();
+  pipeParser = &parser;
+  pipeFault  = false;
+
+#ifdef DSW_STD_THREAD
+  std::thread(parseEntry<P>, this).detach();
+#else
+  if (xTaskCreatePinnedToCore(parseEntry<P>, "DSW_parse", DSW_PARSE_STACK, this,
+                              DSW_PARSE_PRIORITY, nullptr, 1 - xPortGetCoreID()) != pdPASS)
   {
-    if (strcmp(iconList[i], val) == 0) break;
+    Serial.println("No parse task, parsing on this task");
+    return 0;
   }
-  if ( i >= MAX_ICON_INDEX) i = 0;
-  return i;
+#endif
+
+  do {
+    state = pipeBlock(client);
+    if (!state) yield();
+  } while (!state);
+
+  // Wait for the parse task to use what is in the ring
+  ring->finish();
+  while (!ring->closed()) DSW_ring::pause();
+
+  if (state < 0 || pipeFault) return -1;
+  return endResponse();
 }
 
 /***************************************************************************************
-** Function name:           iconFilename
-** Description:             Convert the icon array index to an icon filename
+** Function name:           pipeBlock
+** Description:             Read one block into the ring, 0 if there is more to read
 ***************************************************************************************/
-const char* DS_Weather::iconName(uint8_t index)
+// As readBlock() but the body goes to the ring. Only as much as the ring has space for
+// is read, so when the parser falls behind the data waits in the socket. Returns 1 at
+// the end of the body or when the parse task has stopped, -1 on a timeout.
+template <class T>
+int8_t DS_Weather::pipeBlock(T &client)
 {
-  return iconList[index];
-}
-
-/***************************************************************************************
-** Function name:           value (full data set)
-** Description:             Stores the parsed data in the structures for sketch access
-***************************************************************************************/
- // Nested "if" with "return" reduces comparison count for each key
- 
-#ifndef MINIMISE_DATA_POINTS   // Collect full data point set if this is NOT defined <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+  if (ring->closed() && !draining)
+  {
+    // The parse task has all the requested data, or has failed
+    if (pipeFault) return -1;
+    Serial.println("All requested data received");
+#ifdef DSW_KEEP_ALIVE
+    if (header.close || (!header.chunked && header.contentLength < 0)) return 1;
+    draining = true;
+#else
+    return 1;
+#endif
+  }
 
-void DS_Weather::value(const char *val) {
+  if ( !(client.available() > 0 || client.connected()) || bodyEnd()) return 1;
 
-   String value = val;
+  int count = client.available();
+  if (count > 0)
+  {
+    if (count > DSW_BUFFER_SIZE) count = DSW_BUFFER_SIZE;
+    if (bodyRemaining > 0 && count > bodyRemaining) count = bodyRemaining;
 
-  // Start of JSON
-  //if (currentParent == "") {
-  //  if (currentKey == "timezone") current->timezone = value;
-  //}
+    // Chunk framing makes the body smaller, never larger, so this always fits
+    if (!draining && (uint32_t)count > ring->space())
+    {
+      count = ring->space();
+      if (!count) ring->waitForSpace();
+    }
 
-  // Current forecast - no array index - short path
-  if (currentParent == "currently") {
-    data_set = "currently";
-    if (currentKey == "time") current->time = (uint32_t)value.toInt();
-    else
-    if (currentKey == "summary") current->summary = value;
-    else
-    if (currentKey == "icon") current->icon = iconIndex(val);
-    else
-    if (currentKey == "precipIntensity") current->precipIntensity = value.toFloat();
-    else
-    if (currentKey == "precipType") current->precipType = iconIndex(val);
-    else
-    if (currentKey == "precipProbability") current->precipProbability = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "temperature") current->temperature = value.toFloat();
-    else
-    if (currentKey == "humidity") current->humidity = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "pressure") current->pressure = value.toFloat();
-    else
-    if (currentKey == "windSpeed") current->windSpeed = value.toFloat();
-    else
-    if (currentKey == "windGust") current->windGust = value.toFloat();
-    else
-    if (currentKey == "windBearing") current->windBearing = (uint16_t)value.toInt();
-    else
-    if (currentKey == "cloudCover") current->cloudCover = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "x") current->x = value;
-    return;
-  }
+    if (count > 0) count = client.read(rxBuffer, count);
+    if (count > 0)
+    {
+      received += count;
+      if (bodyRemaining > 0) bodyRemaining -= count;
 
-    // Minutely data collection
-  if (currentParent == "minutely") {
-    data_set = currentParent; // Save parent object to trigger the hourly array
-    minutely->time[0] = 0;
-    if (currentKey == "summary") minutely->overallSummary = value;
-    //else
-    //if (currentKey == "x") minutely->x = value;
-    return;
+      int length = header.chunked ? dechunk(rxBuffer, count) : count;
+      if (length > 0 && !draining) ring->write(rxBuffer, length);
+    }
   }
 
-  // Hourly data collection
-  if (currentParent == "hourly") {
-    data_set = currentParent; // Save parent object to trigger the hourly array
-    hourly->time[0] = 0;
-    if (currentKey == "summary") hourly->overallSummary = value;
-    //else
-    //if (currentKey == "x") hourly->x = value;
-    return;
-  }
+  if ((millis() - responseStart) > 8000UL)
+  {
+    if (draining) return 1; // The socket is not reused
 
-  // Daily data collection
-  if (currentParent == "daily") {
-    data_set = currentParent; // Save parent to trigger the daily array
-    daily->time[0] = 0;
-    if (currentKey == "summary") daily->overallSummary = value;
-    //else
-    //if (currentKey == "x") daily->x = value;
-    return;
+    Serial.println ("JSON parse client timeout");
+    return -1;
   }
 
-    // Collect array data after "data_set" has been set by parent
+  return 0;
+}
+
+/***************************************************************************************
+** Function name:           parseEntry
+** Description:             Parse task function
+***************************************************************************************/
+template <class P>
+void DS_Weather::parseEntry(void *weather)
+{
+  DS_Weather *dsw = (DS_Weather *)weather;
+  dsw->parseRing(*(P *)dsw->pipeParser);
+
+#ifndef DSW_STD_THREAD
+  vTaskDelete(nullptr);
+#endif
+}
 
-  // minutely data[N] array
-  if (data_set == "minutely") {
-    if (minutely_index >= MAX_MINUTES) return;
-    if (currentKey == "time") {
-      // Only increment after the first entry
-      if (minutely->time[0] > 0)
+/***************************************************************************************
+** Function name:           parseRing
+** Description:             Feed the ring to the parser until it ends or the data is complete
+***************************************************************************************/
+// The ring is parsed in place. close() is the last access to this object, after it the
+// reading task may return and the parser go out of scope.
+template <class P>
+void DS_Weather::parseRing(P &parser)
+{
+  for (;;)
+  {
+    const uint8_t *data;
+    uint32_t count = ring->peek(&data);
+
+    if (count)
+    {
+      if (!compressed) parseBlock(parser, data, count);
+      else if (!inflateBlock(parser, data, count))
       {
-        minutely_index++;
-        if (minutely_index >= MAX_MINUTES) return;
+        Serial.print("Inflate error "); Serial.println(inflater->error());
+
+        // Stop asking for gzip, the sketch can set a larger window
+        if (inflater->error() == DSW_INFLATE_WINDOW) inflateOff = true;
+        pipeFault = true;
+        break;
       }
-      minutely->time[minutely_index] = (uint32_t)value.toInt();
+
+      ring->consume(count);
+      if (dataComplete) break;
     }
     else
-    if (currentKey == "precipIntensity") minutely->precipIntensity[minutely_index] = value.toFloat();
-    else
-    if (currentKey == "precipProbability") minutely->precipProbability[minutely_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "x") minutely->x[minutely_index] = value;
-    return;
-  }
-
-  // Collect array data after "data_set" has been set by parent
-
-  // Hourly data[N] array
-  if (data_set == "hourly") {
-    if (hourly_index >= MAX_HOURS) return;
-    if (currentKey == "time") {
-      // Only increment after the first entry
-      if (hourly->time[0] > 0)
+    {
+      // finish() follows the last write, so the ring is only empty for good if it is
+      // still empty after finished() is seen
+      bool end = ring->finished();
+      if (!ring->available())
       {
-        hourly_index++;
-        if (hourly_index >= MAX_HOURS) return;
+        if (end) break;
+        ring->waitForData();
       }
-      hourly->time[hourly_index] = (uint32_t)value.toInt();
     }
-    else
-    if (currentKey == "summary") hourly->summary[hourly_index] = value;
-    else
-    if (currentKey == "precipIntensity") hourly->precipIntensity[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "precipType") hourly->precipType[hourly_index] = iconIndex(val);
-    else
-    if (currentKey == "precipProbability") hourly->precipProbability[hourly_index] = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "precipAccumulation") hourly->precipAccumulation[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "temperature") hourly->temperature[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "pressure") hourly->pressure[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "cloudCover") hourly->cloudCover[hourly_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "x") hourly->x[hourly_index] = value;
-    return;
   }
 
+  ring->close();
+}
+#endif
+
+/***************************************************************************************
+** Function name:           endResponse
+** Description:             Report the end of the response, 1 if a header was received
+***************************************************************************************/
+int8_t DS_Weather::endResponse()
+{
+  // A body that ends inside the JSON document before the bound data is complete has
+  // been cut short, the structs hold part of a forecast
+  if (headerDone && depth && !dataComplete)
+  {
+    Serial.println("Response truncated");
+    parseOK = false;
+  }
 
-  // Daily data[N] array
-  if (data_set == "daily") {
-    if (daily_index >= MAX_DAYS) return;
-    if (currentKey == "time") {
-      // Only increment after the first entry
-      if (daily->time[0] > 0)
-      {
-        daily_index++;
-        if (daily_index >= MAX_DAYS) return;
-      }
-      daily->time[daily_index] = (uint32_t)value.toInt();
-    }
-    else
-    if (currentKey == "summary") daily->summary[daily_index] = value;
-    else
-    if (currentKey == "icon") daily->icon[daily_index] = iconIndex(val);
-    else
-    if (currentKey == "sunriseTime") daily->sunriseTime[daily_index] = (uint32_t)value.toInt();
-    else
-    if (currentKey == "sunsetTime") daily->sunsetTime[daily_index] = (uint32_t)value.toInt();
-    else
-    if (currentKey == "moonPhase") daily->moonPhase[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "precipIntensity") daily->precipIntensity[daily_index] = value.toFloat();
-    else
-    if (currentKey == "precipProbability") daily->precipProbability[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "precipType") daily->precipType[daily_index] = iconIndex(val);
-    else
-    if (currentKey == "precipAccumulation") daily->precipAccumulation[daily_index] = value.toFloat();
-    else
-    if (currentKey == "temperatureHigh") daily->temperatureHigh[daily_index] = value.toFloat();
-    else
-    if (currentKey == "temperatureLow") daily->temperatureLow[daily_index] = value.toFloat();
-    else
-    if (currentKey == "humidity") daily->humidity[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "pressure") daily->pressure[daily_index] = value.toFloat();
-    else
-    if (currentKey == "windSpeed") daily->windSpeed[daily_index] = value.toFloat();
-    else
-    if (currentKey == "windGust") daily->windGust[daily_index] = value.toFloat();
-    else
-    if (currentKey == "windBearing") daily->windBearing[daily_index] = (uint16_t)value.toInt();
-    else
-    if (currentKey == "cloudCover") daily->cloudCover[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "x") daily->x[daily_index] = value;
-    //return;
+  if (compressed)
+  {
+    Serial.print("Inflated "); Serial.print(inflater->bytesIn());
+    Serial.print(" to ");      Serial.print(inflater->bytesOut());
+    Serial.print(" bytes, furthest reference "); Serial.println(inflater->maxDistance());
   }
 
+  return headerDone ? 1 : -1;
 }
 
+/***************************************************************************************
+** Function name:           inflateBlock
+** Description:             Decompress a block of the body and feed it to the parser
+***************************************************************************************/
+// The output is parsed straight from the inflater window, the window end splits it into
+// more than one run if it wraps
+template <class P>
+bool DS_Weather::inflateBlock(P &parser, const uint8_t *buffer, int count)
+{
+  for (;;)
+  {
+    const uint8_t *out;
+    int n;
+    int used = inflater->inflate(buffer, count, &out, &n);
+    buffer += used;
+    count  -= used;
+
+    if (n > 0) parseBlock(parser, out, n);
 
-#else  // MINIMISE_DATA_POINTS: Collect full data point set if this IS defined <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-       // data points reduced for TFT_eSPI example to reduce memory requirements
+    if (inflater->error()) return false;
+    if ((!used && !n) || dataComplete) return true;
+  }
+}
 
 /***************************************************************************************
-** Function name:           value (partial data set)
-** Description:             Stores the parsed data in the structures for sketch access
+** Function name:           headerStart
+** Description:             Clear the header values and scanner state for a new response
 ***************************************************************************************/
-void DS_Weather::value(const char *val) {
+void DS_Weather::headerStart()
+{
+  header.status        = 0;
+  header.contentLength = -1;
+  header.chunked       = false;
+  header.encoding      = DSW_ENCODING_IDENTITY;
+  header.apiCalls      = -1;
+  header.close         = false;
+
+  headerDone = false;
+  lineLength = 0;
+
+  responseStart = millis();
+  received      = 0;
+  draining      = false;
+  compressed    = false;
+
+  bodyRemaining  = -1;
+  chunkState     = DSW_CHUNK_SIZE;
+  chunkRemaining = 0;
+}
 
-   String value = val;
+/***************************************************************************************
+** Function name:           scanHeader
+** Description:             Collect header lines, returns the number of bytes used
+***************************************************************************************/
+// No heap is used, each line is collected in the fixed lineBuffer. Lines longer than the
+// buffer are truncated, only the start of the lines of interest is needed.
+int DS_Weather::scanHeader(const uint8_t *buffer, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    char c = buffer[i];
 
-  // Start of JSON
-  //if (currentParent == "") {
-  //  if (currentKey == "timezone") current->timezone = value;
-  //}
+    if (c == '\r') continue;
 
-  // Current forecast - no array index
-  if (currentParent == "currently") {
-    data_set = "currently";
-    if (currentKey == "time") current->time = (uint32_t)value.toInt();
-    else
-    if (currentKey == "summary") current->summary = value;
-    else
-    if (currentKey == "icon") current->icon = iconIndex(val);
-    //else
-    //if (currentKey == "precipIntensity") current->precipIntensity = value.toFloat();
-    //else
-    //if (currentKey == "precipType") current->precipType = iconIndex(val);
-    //else
-    //if (currentKey == "precipProbability") current->precipProbability = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "temperature") current->temperature = value.toFloat();
-    else
-    if (currentKey == "humidity") current->humidity = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "pressure") current->pressure = value.toFloat();
-    else
-    if (currentKey == "windSpeed") current->windSpeed = value.toFloat();
-    //else
-    //if (currentKey == "windGust") current->windGust = value.toFloat();
-    else
-    if (currentKey == "windBearing") current->windBearing = (uint16_t)value.toInt();
-    else
-    if (currentKey == "cloudCover") current->cloudCover = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "x") current->x = value;
-    return;
-  }
+    if (c != '\n')
+    {
+      if (lineLength < DSW_LINE_SIZE - 1) lineBuffer[lineLength++] = c;
+      continue;
+    }
 
-#if !defined (MINIMISE_DATA_POINTS)
-  // Hourly data collection
-  if (currentParent == "hourly") {
-    data_set = currentParent; // Save parent to trigger the hourly array
-    hourly->time[0] = 0;
-    if (currentKey == "summary") hourly->overallSummary = value;
-    //else
-    //if (currentKey == "x") hourly->x = value;
-    return;
+    lineBuffer[lineLength] = 0;
+
+    // A blank line ends the header, the status line must have been seen
+    if (lineLength == 0 && header.status)
+    {
+      Serial.println("Header end found");
+      headerDone = true;
+      return i + 1;
+    }
+
+    if (lineLength) headerLine();
+    lineLength = 0;
   }
+
+  return count;
+}
+
+/***************************************************************************************
+** Function name:           headerLine
+** Description:             Decode a complete header line held in lineBuffer
+***************************************************************************************/
+void DS_Weather::headerLine()
+{
+#ifdef SHOW_HEADER
+  Serial.println(lineBuffer);
 #endif
 
-  // Daily data collection
-  if (currentParent == "daily") {
-    data_set = currentParent; // Save parent to trigger the daily array
-    daily->time[0] = 0;
-    if (currentKey == "summary") daily->overallSummary = value;
-    //else
-    //if (currentKey == "x") daily->x = value;
+  // Status line e.g. "HTTP/1.1 200 OK"
+  if (!header.status)
+  {
+    const char *code = strchr(lineBuffer, ' ');
+    if (strncmp(lineBuffer, "HTTP/", 5) == 0 && code) header.status = atoi(code + 1);
+    if (strncmp(lineBuffer, "HTTP/1.0", 8) == 0) header.close = true; // No keep-alive by default
     return;
   }
 
-  // Collect array data after "data_set" has been set by parent
-#if !defined (MINIMISE_DATA_POINTS)
-  // Hourly data[N] array
-  if (data_set == "hourly") {
-    if (hourly_index >= MAX_HOURS) return;
-    if (currentKey == "time") {
-      // Only increment after the first entry
-      if (hourly->time[0] > 0)
+  char *colon = strchr(lineBuffer, ':');
+  if (!colon) return;
+
+  // Field names are case insensitive
+  *colon = 0;
+  const char *name = lineBuffer;
+  const char *val = colon + 1;
+  while (*val == ' ' || *val == '\t') val++;
+
+  if (!strcasecmp(name, "Content-Length")) header.contentLength = atol(val);
+  else if (!strcasecmp(name, "Transfer-Encoding")) header.chunked = !strncasecmp(val, "chunked", 7);
+  else if (!strcasecmp(name, "Content-Encoding"))
+  {
+    if (!strncasecmp(val, "gzip", 4)) header.encoding = DSW_ENCODING_GZIP;
+    else if (!strncasecmp(val, "deflate", 7)) header.encoding = DSW_ENCODING_DEFLATE;
+    else if (strncasecmp(val, "identity", 8)) header.encoding = DSW_ENCODING_OTHER;
+  }
+  else if (!strcasecmp(name, "X-Forecast-API-Calls")) header.apiCalls = atol(val);
+  else if (!strcasecmp(name, "Connection")) header.close = !strncasecmp(val, "close", 5);
+}
+
+/***************************************************************************************
+** Function name:           dechunk
+** Description:             Remove the chunked transfer framing from a block in place
+***************************************************************************************/
+// The decoder state is kept between blocks, so a chunk size line or the CRLF after the
+// data may be split across blocks. Chunk extensions and trailer lines are skipped.
+int DS_Weather::dechunk(uint8_t *buffer, int count)
+{
+  int out = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    uint8_t c = buffer[i];
+
+    switch (chunkState)
+    {
+      case DSW_CHUNK_DATA:
       {
-        hourly_index++;
-        if (hourly_index >= MAX_HOURS) return;
+        // Move as much of the chunk as the block holds down to the end of the body so far
+        int n = count - i;
+        if ((uint32_t)n > chunkRemaining) n = chunkRemaining;
+        if (out != i) memmove(buffer + out, buffer + i, n);
+        out += n;
+        i   += n - 1;
+        chunkRemaining -= n;
+        if (chunkRemaining == 0) chunkState = DSW_CHUNK_END;
+        break;
       }
-      hourly->time[hourly_index] = (uint32_t)value.toInt();
+
+      case DSW_CHUNK_SIZE:
+      case DSW_CHUNK_EXTENSION:
+        if (c == '\n')
+        {
+          // A zero size chunk is the last one
+          chunkState = chunkRemaining ? DSW_CHUNK_DATA : DSW_CHUNK_TRAILER;
+          lineLength = 0;
+        }
+        else if (chunkState == DSW_CHUNK_SIZE)
+        {
+          if      (c >= '0' && c <= '9') chunkRemaining = (chunkRemaining << 4) | (c - '0');
+          else if (c >= 'a' && c <= 'f') chunkRemaining = (chunkRemaining << 4) | (c - 'a' + 10);
+          else if (c >= 'A' && c <= 'F') chunkRemaining = (chunkRemaining << 4) | (c - 'A' + 10);
+          else if (c != '\r') chunkState = DSW_CHUNK_EXTENSION;
+        }
+        break;
+
+      case DSW_CHUNK_END:
+        if (c == '\n') chunkState = DSW_CHUNK_SIZE;
+        break;
+
+      case DSW_CHUNK_TRAILER:
+        // A blank line ends the trailer
+        if (c == '\n')
+        {
+          if (lineLength == 0) chunkState = DSW_CHUNK_DONE;
+          lineLength = 0;
+        }
+        else if (c != '\r') lineLength = 1;
+        break;
+
+      default: // DSW_CHUNK_DONE, nothing more is expected
+        return out;
     }
-    else
-    if (currentKey == "summary") hourly->summary[hourly_index] = value;
-    else
-    if (currentKey == "precipIntensity") hourly->precipIntensity[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "precipType") hourly->precipType[hourly_index] = iconIndex(val);
-    else
-    if (currentKey == "precipProbability") hourly->precipProbability[hourly_index] = (uint8_t)(100 * (value.toFloat()));
-    else
-    if (currentKey == "precipAccumulation") hourly->precipAccumulation[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "temperature") hourly->temperature[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "pressure") hourly->pressure[hourly_index] = value.toFloat();
-    else
-    if (currentKey == "cloudCover") hourly->cloudCover[hourly_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "x") hourly->x[hourly_index] = value;
-    return;
   }
+
+  return out;
+}
+
+/***************************************************************************************
+** Function name:           bodyEnd
+** Description:             true when the whole response body has been read
+***************************************************************************************/
+bool DS_Weather::bodyEnd()
+{
+  if (!headerDone) return false;
+  if (header.chunked) return chunkState == DSW_CHUNK_DONE;
+  return bodyRemaining == 0;
+}
+
+/***************************************************************************************
+** Function name:           parseRequest
+** Description:             Fetches the JSON message and feeds to the parser
+***************************************************************************************/
+bool DS_Weather::parseRequest(String url) {
+
+  if (fetch) return false; // The client and parse state belong to the request
+
+  uint32_t dt = millis();
+
+#ifdef DSW_KEEP_ALIVE
+  if (!client) client = new DSW_client;
+  DSW_client &link = *client;
+#else
+  DSW_client link;
 #endif
 
-  // Daily data[N] array
-  if (data_set == "daily") {
-    if (daily_index >= MAX_DAYS) return;
-    if (currentKey == "time") {
-      // Only increment after the first entry
-      if (daily->time[0] > 0)
-      {
-        daily_index++;
-        if (daily_index >= MAX_DAYS) return;
-      }
-      daily->time[daily_index] = (uint32_t)value.toInt();
-    }
-    else
-    if (currentKey == "summary") daily->summary[daily_index] = value;
-    else
-    if (currentKey == "icon") daily->icon[daily_index] = iconIndex(val);
-    else
-    if (currentKey == "sunriseTime") daily->sunriseTime[daily_index] = (uint32_t)value.toInt();
-    else
-    if (currentKey == "sunsetTime") daily->sunsetTime[daily_index] = (uint32_t)value.toInt();
-    else
-    if (currentKey == "moonPhase") daily->moonPhase[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "precipIntensity") daily->precipIntensity[daily_index] = value.toFloat();
-    //else
-    //if (currentKey == "precipProbability") daily->precipProbability[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "precipType") daily->precipType[daily_index] = iconIndex(val);
-    //else
-    //if (currentKey == "precipAccumulation") daily->precipAccumulation[daily_index] = value.toFloat();
-    else
-    if (currentKey == "temperatureHigh") daily->temperatureHigh[daily_index] = value.toFloat();
-    else
-    if (currentKey == "temperatureLow") daily->temperatureLow[daily_index] = value.toFloat();
-    //else
-    //if (currentKey == "humidity") daily->humidity[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "pressure") daily->pressure[daily_index] = value.toFloat();
-    //else
-    //if (currentKey == "windSpeed") daily->windSpeed[daily_index] = value.toFloat();
-    //else
-    //if (currentKey == "windGust") daily->windGust[daily_index] = value.toFloat();
-    //else
-    //if (currentKey == "windBearing") daily->windBearing[daily_index] = (uint16_t)value.toInt();
-    //else
-    //if (currentKey == "cloudCover") daily->cloudCover[daily_index] = (uint8_t)(100 * (value.toFloat()));
-    //else
-    //if (currentKey == "x") daily->x[daily_index] = value;
-    //return;
-  }
-
-}
-  
-#endif // MINIMISE_DATA_POINTS
\ No newline at end of file
+  setupClient(link);
+
+  dsw_parser_t parser;
+  parser.setListener(this);
+
+  // Check the response header and parse the JSON message
+  bool result = sendRequest(link, parser, url);
+
+  Serial.println("");
+  Serial.print("Done in "); Serial.print(millis()-dt); Serial.println(" ms\n");
+
+  parser.reset();
+
+  // A message has been parsed without error but the datapoint correctness is unknown
+  return result && parseOK;
+}
+
+#ifdef ESP32 // Decide if ESP32 or ESP8266 setupClient available
+
+/***************************************************************************************
+** Function name:           setupClient (for ESP32)
+** Description:             Set the certificate checks of the secure client
+***************************************************************************************/
+void DS_Weather::setupClient(DSW_client &link) {
+
+  // This certificate will expire in June 2019, but we can ignore it at line 111
+  const char* dsw_ca_cert = \
+  "-----BEGIN CERTIFICATE-----\n" \
+  "MIIDQTCCAimgAwIBAgITBmyfz5m/jAo54vB4ikPmljZbyjANBgkqhkiG9w0BAQsF\n" \
+  "ADA5MQswCQYDVQQGEwJVUzEPMA0GA1UEChMGQW1hem9uMRkwFwYDVQQDExBBbWF6\n" \
+  "b24gUm9vdCBDQSAxMB4XDTE1MDUyNjAwMDAwMFoXDTM4MDExNzAwMDAwMFowOTEL\n" \
+  "MAkGA1UEBhMCVVMxDzANBgNVBAoTBkFtYXpvbjEZMBcGA1UEAxMQQW1hem9uIFJv\n" \
+  "b3QgQ0EgMTCCASIwDQYJKoZIhvcNAQEBBQADggEPADCCAQoCggEBALJ4gHHKeNXj\n" \
+  "ca9HgFB0fW7Y14h29Jlo91ghYPl0hAEvrAIthtOgQ3pOsqTQNroBvo3bSMgHFzZM\n" \
+  "9O6II8c+6zf1tRn4SWiw3te5djgdYZ6k/oI2peVKVuRF4fn9tBb6dNqcmzU5L/qw\n" \
+  "IFAGbHrQgLKm+a/sRxmPUDgH3KKHOVj4utWp+UhnMJbulHheb4mjUcAwhmahRWa6\n" \
+  "VOujw5H5SNz/0egwLX0tdHA114gk957EWW67c4cX8jJGKLhD+rcdqsq08p8kDi1L\n" \
+  "93FcXmn/6pUCyziKrlA4b9v7LWIbxcceVOF34GfID5yHI9Y/QCB/IIDEgEw+OyQm\n" \
+  "jgSubJrIqg0CAwEAAaNCMEAwDwYDVR0TAQH/BAUwAwEB/zAOBgNVHQ8BAf8EBAMC\n" \
+  "AYYwHQYDVR0OBBYEFIQYzIU07LwMlJQuCFmcx7IQTgoIMA0GCSqGSIb3DQEBCwUA\n" \
+  "A4IBAQCY8jdaQZChGsV2USggNiMOruYou6r4lK5IpDB/G/wkjUu0yKGX9rbxenDI\n" \
+  "U5PMCCjjmCXPI6T53iHTfIUJrU6adTrCC2qJeHZERxhlbI1Bjjt/msv0tadQ1wUs\n" \
+  "N+gDS63pYaACbvXy8MWy7Vu33PqUXHeeE6V/Uq2V8viTO96LXFvKWlJbYK8U90vv\n" \
+  "o/ufQJVtMVT8QtPHRh8jrdkPSHCa2XV4cdFyQzR1bldZwgJcJmApzyMZFo6IQ6XU\n" \
+  "5MsI+yMRQ+hDKXJioaldXgjUkK642M4UwtBV8ob2xJNDd2ZhwLnoQdeXeGADbkpy\n" \
+  "rqXRfboQnoZsG4q5WTP468SQvvG5\n" \
+  "-----END CERTIFICATE-----\n";
+
+  //link.tls.setCACert(dsw_ca_cert);  // Comment out to stop certificate check
+}
+
+#else // ESP8266 version
+
+/***************************************************************************************
+** Function name:           setupClient (for ESP8266)
+** Description:             Set the certificate checks of the secure client
+***************************************************************************************/
+void DS_Weather::setupClient(DSW_client &link) {
+
+  // The AXTLS fingerprint is checked by openConnection()
+  #if !defined(AXTLS)
+    #ifdef SECURE_SSL
+      // BearSSL requires a different fingerprint format and setFingerprint() must be called
+      const uint8_t fp[20] = {0xEB,0xC2,0x67,0xD1,0xB1,0xC6,0x77,0x90,0x51,0xC1,0x4A,0x0A,0xBA,0x83,0xE1,0xF0,0x6D,0x73,0xDD,0xB8};
+      link.tls.setFingerprint(fp);
+    #else
+      link.tls.setInsecure();
+    #endif
+  #endif
+}
+
+#endif // ESP32 or ESP8266 setupClient
+
+/***************************************************************************************
+** Function name:           parseMessage
+** Description:             Parse a JSON message held in memory
+***************************************************************************************/
+bool DS_Weather::parseMessage(const uint8_t *json, size_t length, bool useJsonDecoder)
+{
+  parseOK = false;
+  dataComplete = false;
+
+  if (useJsonDecoder)
+  {
+    JSON_Decoder parser;
+    parser.setListener(this);
+    parseBlock(parser, json, length);
+  }
+  else
+  {
+    DSW_Parser<DS_Weather> parser;
+    parser.setListener(this);
+    parseBlock(parser, json, length);
+  }
+
+  return parseOK;
+}
+
+/***************************************************************************************
+** Function name:           parseBlock
+** Description:             Feed a block of received bytes to the parser
+***************************************************************************************/
+void DS_Weather::parseBlock(DSW_Parser<DS_Weather> &parser, const uint8_t *buffer, int count)
+{
+  showJSON(buffer, count);
+
+  // The parser scans skipped values in a tight loop, so give it the whole block
+  parser.parse(buffer, count);
+}
+
+void DS_Weather::parseBlock(JSON_Decoder &parser, const uint8_t *buffer, int count)
+{
+  showJSON(buffer, count);
+
+  const uint8_t *end = buffer + count;
+  while (buffer < end) parser.parse((char)*buffer++);
+}
+
+/***************************************************************************************
+** Function name:           showJSON
+** Description:             Debug only, simple formatting of the received JSON message
+***************************************************************************************/
+void DS_Weather::showJSON(const uint8_t *buffer, int count)
+{
+#ifdef SHOW_JSON
+  static int ccount = 0;
+  for (int i = 0; i < count; i++)
+  {
+    char c = buffer[i];
+    if (c == '{' || c == '[' || c == '}' || c == ']') Serial.println();
+    Serial.print(c); if (ccount++ > 100 && c == ',') {ccount = 0; Serial.println();}
+  }
+#else
+  (void)buffer; (void)count;
+#endif
+}
+
+/***************************************************************************************
+** Function name:           key etc
+** Description:             These functions are called while parsing the JSON message
+***************************************************************************************/
+void DS_Weather::key(const char *key) {
+
+  currentKeyId = keyId(key);
+  currentField = fieldId(currentKeyId);
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n>>> Key >>>"); Serial.print(key);
+#endif
+}
+
+void DS_Weather::startDocument() {
+
+  currentKeyId = DSW_KEY_NONE;
+  currentField = DSW_FIELD_NONE;
+  depth = 0;
+  arrayLevels = 0;
+  dataIndex = 0;
+  parseOK = true;
+
+  // Sections with data points bound, each is cleared when its data is complete
+  pendingSections = 0;
+  for (uint8_t section = 0; section < DSW_SECTIONS; section++)
+    if (binding.fields[section]) pendingSections |= (1 << section);
+  dataComplete = false;
+
+  if (binding.textPool) binding.textPool->clear();
+
+  memset(&snapshot, 0, sizeof(snapshot));
+
+  changedFields = 0;
+  timeBaseSet = 0;
+  timeBaseMoved = 0;
+
+  for (uint8_t a = 0; a < aggregateCount; a++) {
+    DSW_aggregate &g = aggregates[a];
+    g.n = 0;
+    g.min = g.max = g.sum = 0;
+    g.minIndex = g.maxIndex = g.crossIndex = DSW_NOT_FOUND;
+  }
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n>>> Start document >>>");
+#endif
+}
+
+void DS_Weather::endDocument() {
+
+  currentKeyId = DSW_KEY_NONE;
+  currentField = DSW_FIELD_NONE;
+  depth = 0;
+  arrayLevels = 0;
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n<<< End document <<<");
+#endif
+}
+
+void DS_Weather::startObject() {
+
+  enterLevel(false);
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n>>> Start object level:"); Serial.print(depth);
+  Serial.print(" index:"); Serial.print(dataIndex); Serial.print(" >>>");
+#endif
+}
+
+void DS_Weather::endObject() {
+
+  // Move to next array element when a data point closes
+  if (inDataPoint())
+  {
+    uint8_t section = sectionOf(contextKey[1]);
+
+    // Pass a streamed data point to the sketch then clear the record for the next one
+    if (streamSections & (1 << section))
+    {
+      pointCallback(section, dataIndex, *streamPoint);
+      streamPoint->clear();
+    }
+
+    dataIndex++;
+
+    // A section is complete when its arrays are full (the "data" array is sent last)
+    if (!(streamSections & (1 << section)) && dataIndex >= binding.size[section] &&
+        dataIndex >= watchedEnd[section]) sectionDone(section);
+  }
+
+  // End of a section object
+  if (depth == 2) sectionDone(sectionOf(contextKey[1]));
+
+  exitLevel();
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n<<< End object <<<");
+#endif
+}
+
+void DS_Weather::startArray() {
+
+  enterLevel(true);
+  dataIndex = 0;
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n>>> Start array level:"); Serial.print(depth); Serial.print(" >>>");
+#endif
+}
+
+void DS_Weather::endArray() {
+
+  exitLevel();
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n<<< End array <<<");
+#endif
+}
+
+void DS_Weather::whitespace(char c) {
+}
+
+/***************************************************************************************
+** Function name:           sectionDone
+** Description:             Note a section is complete, set dataComplete when all are
+***************************************************************************************/
+void DS_Weather::sectionDone(uint8_t section) {
+
+  if (section >= DSW_SECTIONS || !(pendingSections & (1 << section))) return;
+
+  pendingSections &= ~(1 << section);
+  if (!pendingSections) dataComplete = true;
+
+#ifdef SHOW_CALLBACK
+  Serial.print("\n<<< Section complete:"); Serial.print(section); Serial.print(" <<<");
+#endif
+}
+
+/***************************************************************************************
+** Function name:           skipValue
+** Description:             Decide if DSW_Parser can skip the value of the last key
+***************************************************************************************/
+// Called after key(), the parser then scans past the value without callbacks. Keys of
+// no interest are skipped whole, e.g. "apparentTemperature", "flags" or a section with
+// no data points bound, but the objects and "data" arrays leading to bound fields are not.
+bool DS_Weather::skipValue() {
+
+  if (currentField != DSW_FIELD_NONE) return false;
+
+  // Keep a section object if any of its data points are bound
+  if (depth == 1)
+  {
+    uint8_t section = sectionOf(currentKeyId);
+    return (section == DSW_SECTIONS) || !binding.fields[section];
+  }
+
+  // Keep the section "data" array
+  if (depth == 2 && currentKeyId == DSW_KEY_data) return false;
+
+  return true;
+}
+
+void DS_Weather::error( const char *message ) {
+  Serial.print("\nParse error message: ");
+  Serial.print(message);
+  parseOK = false;
+}
+
+/***************************************************************************************
+** Function name:           enterLevel
+** Description:             Push an object or array onto the parse context stack
+***************************************************************************************/
+void DS_Weather::enterLevel(bool array)
+{
+  if (depth < DSW_MAX_DEPTH)
+  {
+    // Array elements are unnamed, otherwise the last key names the object/array
+    if (depth && (arrayLevels & (1 << (depth - 1)))) contextKey[depth] = DSW_KEY_NONE;
+    else contextKey[depth] = currentKeyId;
+
+    if (array) arrayLevels |= (1 << depth);
+    else arrayLevels &= ~(1 << depth);
+  }
+
+  // Keep counting beyond the stack size so levels stay balanced, deeper levels are ignored
+  if (depth < 255) depth++;
+  currentKeyId = DSW_KEY_NONE;
+  currentField = DSW_FIELD_NONE;
+}
+
+/***************************************************************************************
+** Function name:           exitLevel
+** Description:             Pop an object or array from the parse context stack
+***************************************************************************************/
+void DS_Weather::exitLevel()
+{
+  if (depth) depth--;
+  currentKeyId = DSW_KEY_NONE;
+  currentField = DSW_FIELD_NONE;
+}
+
+/***************************************************************************************
+** Function name:           inDataPoint
+** Description:             Check if the parser is in an element of a "data" array
+***************************************************************************************/
+// The stack is root object, section object e.g. "hourly", "data" array, element object
+bool DS_Weather::inDataPoint()
+{
+  return (depth == 4) && (contextKey[2] == DSW_KEY_data) && (arrayLevels & (1 << 2))
+                      && !(arrayLevels & (1 << 3));
+}
+
+/***************************************************************************************
+** Function name:           keyId
+** Description:             Convert a JSON name to a key identifier
+***************************************************************************************/
+#define DSW_KEY_NAME(name) #name,
+static const char* const keyList[DSW_KEY_COUNT] = { "", DSW_KEY_LIST(DSW_KEY_NAME) };
+
+#define DSW_KEY_CASE(name) case dsw_hash(#name): id = DSW_KEY_##name; break;
+
+dsw_key_t DS_Weather::keyId(const char *key)
+{
+  dsw_key_t id = DSW_KEY_NONE;
+
+  switch (dsw_hash(key)) {
+    DSW_KEY_LIST(DSW_KEY_CASE)
+    default: return DSW_KEY_NONE;
+  }
+
+  // Confirm the match, an unused key could have the same hash
+  if (strcmp(keyList[id], key) != 0) return DSW_KEY_NONE;
+  return id;
+}
+
+/***************************************************************************************
+** Function name:           scanDecimal
+** Description:             Split a JSON number string into a mantissa and exponent
+***************************************************************************************/
+// The number is m * 10^e, e.g. "-0.58" gives m = 58, e = -2, neg = true. Digits that
+// would overflow the 32 bit mantissa are dropped. Only integer operations are used.
+void DS_Weather::scanDecimal(const char *val, uint32_t *m, int16_t *e, bool *neg)
+{
+  *m = 0; *e = 0; *neg = false;
+
+  if (*val == '-') { *neg = true; val++; }
+
+  for (; *val >= '0' && *val <= '9'; val++) {
+    if (*m < 429496729UL || (*m == 429496729UL && *val <= '5')) *m = *m * 10 + (*val - '0');
+    else (*e)++; // Integer digit dropped
+  }
+
+  if (*val == '.') {
+    for (val++; *val >= '0' && *val <= '9'; val++) {
+      if (*m < 429496729UL) { *m = *m * 10 + (*val - '0'); (*e)--; }
+    }
+  }
+
+  if (*val == 'e' || *val == 'E') {
+    val++;
+    bool negExp = (*val == '-');
+    if (*val == '-' || *val == '+') val++;
+    int16_t x = 0;
+    for (; *val >= '0' && *val <= '9'; val++) if (x < 100) x = x * 10 + (*val - '0');
+    *e += negExp ? -x : x;
+  }
+}
+
+/***************************************************************************************
+** Function name:           fixedPoint
+** Description:             Decode a JSON number to an integer scaled by 10^decimals
+***************************************************************************************/
+// e.g. fixedPoint("1026.47", 1) returns 10264, excess decimal places are truncated.
+// Out of range values are limited to the int32_t range.
+int32_t DS_Weather::fixedPoint(const char *val, uint8_t decimals)
+{
+  uint32_t m; int16_t e; bool neg;
+  scanDecimal(val, &m, &e, &neg);
+
+  e += decimals;
+  if (e < -10) m = 0;
+  for (; e < 0 && m; e++) m /= 10;
+  for (; e > 0 && m; e--) {
+    if (m > 214748364UL) { m = 2147483647UL; break; }
+    m *= 10;
+  }
+  if (m > 2147483647UL) m = 2147483647UL;
+
+  return neg ? -(int32_t)m : (int32_t)m;
+}
+
+/***************************************************************************************
+** Function name:           toUnsigned
+** Description:             Decode a JSON number to an unsigned integer e.g. a unix time
+***************************************************************************************/
+uint32_t DS_Weather::toUnsigned(const char *val)
+{
+  uint32_t m; int16_t e; bool neg;
+  scanDecimal(val, &m, &e, &neg);
+
+  if (neg) return 0;
+  for (; e < 0 && m; e++) m /= 10;
+  for (; e > 0 && m; e--) {
+    if (m > 429496729UL) return 0xFFFFFFFFUL;
+    m *= 10;
+  }
+  return m;
+}
+
+/***************************************************************************************
+** Function name:           toPercent
+** Description:             Decode a 0 to 1 JSON number as an integer percentage
+***************************************************************************************/
+uint8_t DS_Weather::toPercent(const char *val)
+{
+  int32_t pc = fixedPoint(val, 2);
+  if (pc < 0) return 0;
+  if (pc > 255) return 255;
+  return (uint8_t)pc;
+}
+
+/***************************************************************************************
+** Function name:           decimalToFloat
+** Description:             Decode a JSON number for a float data point
+***************************************************************************************/
+// A single multiply or divide by a power of ten, no atof() or String copy needed
+float DS_Weather::decimalToFloat(const char *val)
+{
+  static const float pow10[] = { 1.0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+  uint32_t m; int16_t e; bool neg;
+  scanDecimal(val, &m, &e, &neg);
+
+  float f = (float)m;
+  if (f != 0) {
+    while (e < -10) { f /= 1e10f; e += 10; }
+    while (e >  10) { f *= 1e10f; e -= 10; }
+    if (e < 0) f /= pow10[-e];
+    else f *= pow10[e];
+  }
+
+  return neg ? -f : f;
+}
+
+/***************************************************************************************
+** Function name:           iconIndex
+** Description:             Convert the icon name to an array index to save memory
+***************************************************************************************/
+uint8_t DS_Weather::iconIndex(const char *val)
+{
+  if (*val == 0) return MAX_ICON_INDEX; // null so return index for none
+
+  // Hash case values must track the iconList[] order, the name is kept to confirm the match
+  #define DSW_ICON_CASE(n, name) case dsw_hash(name): i = n; match = name; break;
+
+  uint8_t i = 0;
+  const char *match;
+  switch (dsw_hash(val)) {
+    DSW_ICON_CASE( 1, "rain")
+    DSW_ICON_CASE( 2, "sleet")
+    DSW_ICON_CASE( 3, "snow")
+    DSW_ICON_CASE( 4, "clear-day")
+    DSW_ICON_CASE( 5, "clear-night")
+    DSW_ICON_CASE( 6, "partly-cloudy-day")
+    DSW_ICON_CASE( 7, "partly-cloudy-night")
+    DSW_ICON_CASE( 8, "cloudy")
+    DSW_ICON_CASE( 9, "fog")
+    DSW_ICON_CASE(10, "wind")
+    default: return 0; // "unknown" (also "none", as before)
+  }
+
+  if (strcmp(match, val) != 0) i = 0;
+  return i;
+}
+
+// A partly-cloudy-night means a clear day as noted in issue #7
+const char* const DS_Weather::iconList[MAX_ICON_INDEX + 1] = {"unknown", "rain", "sleet", "snow", "clear-day",
+  "clear-night", "partly-cloudy-day", "partly-cloudy-night", "cloudy", "fog",
+  "wind", "none" };
+
+/***************************************************************************************
+** Function name:           iconFilename
+** Description:             Convert the icon array index to an icon filename
+***************************************************************************************/
+const char* DS_Weather::iconName(uint8_t index)
+{
+  return iconList[index];
+}
+
+/***************************************************************************************
+** Function name:           fieldId
+** Description:             Find the data point for a key in the current parse context
+***************************************************************************************/
+// The case statements are generated from the data point lists in Data_Point_Set.h,
+// depth 2 is a name:value pair in a section object e.g. "currently", depth 4 is in
+// an element of a section "data" array. The only root object value stored is the
+// current timezone. Data points the sketch has not selected
+// return DSW_FIELD_NONE so value() can ignore them without further checks.
+#define DSW_FIELD_CASE(S, s, m, k, kind) case DSW_KEY_##k: field = DSW_FIELD_##s##_##m; break;
+
+uint8_t DS_Weather::fieldId(dsw_key_t key)
+{
+  uint8_t field = DSW_FIELD_NONE;
+  uint8_t section, base;
+
+  if (key == DSW_KEY_NONE) return DSW_FIELD_NONE;
+
+  if (depth == 1) {
+    if (key != DSW_KEY_timezone) return DSW_FIELD_NONE;
+    section = DSW_CURRENT; base = DSW_CURRENT_BASE;
+    field = DSW_FIELD_current_timezone;
+  }
+  else if (depth == 2) switch (contextKey[1]) {
+    case DSW_KEY_currently:
+      section = DSW_CURRENT; base = DSW_CURRENT_BASE;
+      switch (key) { DSW_CURRENT_SCALARS(DSW_FIELD_CASE, CURRENT, current) default: break; }
+      break;
+    case DSW_KEY_minutely:
+      section = DSW_MINUTELY; base = DSW_MINUTELY_BASE;
+      switch (key) { DSW_MINUTELY_SCALARS(DSW_FIELD_CASE, MINUTELY, minutely) default: break; }
+      break;
+    case DSW_KEY_hourly:
+      section = DSW_HOURLY; base = DSW_HOURLY_BASE;
+      switch (key) { DSW_HOURLY_SCALARS(DSW_FIELD_CASE, HOURLY, hourly) default: break; }
+      break;
+    case DSW_KEY_daily:
+      section = DSW_DAILY; base = DSW_DAILY_BASE;
+      switch (key) { DSW_DAILY_SCALARS(DSW_FIELD_CASE, DAILY, daily) default: break; }
+      break;
+    default: return DSW_FIELD_NONE;
+  }
+  else if (inDataPoint()) switch (contextKey[1]) {
+    case DSW_KEY_minutely:
+      section = DSW_MINUTELY; base = DSW_MINUTELY_BASE;
+      switch (key) { DSW_MINUTELY_ARRAYS(DSW_FIELD_CASE, MINUTELY, minutely) default: break; }
+      break;
+    case DSW_KEY_hourly:
+      section = DSW_HOURLY; base = DSW_HOURLY_BASE;
+      switch (key) { DSW_HOURLY_ARRAYS(DSW_FIELD_CASE, HOURLY, hourly) default: break; }
+      break;
+    case DSW_KEY_daily:
+      section = DSW_DAILY; base = DSW_DAILY_BASE;
+      switch (key) { DSW_DAILY_ARRAYS(DSW_FIELD_CASE, DAILY, daily) default: break; }
+      break;
+    default: return DSW_FIELD_NONE;
+  }
+  else return DSW_FIELD_NONE;
+
+  // Check the sketch wants this data point
+  if (field == DSW_FIELD_NONE) return DSW_FIELD_NONE;
+  if (!(binding.fields[section] & (1UL << (field - base)))) return DSW_FIELD_NONE;
+
+  return field;
+}
+
+/***************************************************************************************
+** Function name:           value
+** Description:             Stores the parsed data in the structures for sketch access
+***************************************************************************************/
+// The kind of each field, generated from the data point lists
+#define DSW_KIND_ENTRY(S, s, m, k, kind) DSW_KIND_##kind,
+static_assert(DSW_FIELD_COUNT <= 64, "Watched field bits are a uint64_t");
+
+static const uint8_t fieldKind[DSW_FIELD_COUNT] = {
+  DSW_CURRENT_SCALARS(DSW_KIND_ENTRY, CURRENT, current)
+  DSW_MINUTELY_SCALARS(DSW_KIND_ENTRY, MINUTELY, minutely)
+  DSW_MINUTELY_ARRAYS(DSW_KIND_ENTRY, MINUTELY, minutely)
+  DSW_HOURLY_SCALARS(DSW_KIND_ENTRY, HOURLY, hourly)
+  DSW_HOURLY_ARRAYS(DSW_KIND_ENTRY, HOURLY, hourly)
+  DSW_DAILY_SCALARS(DSW_KIND_ENTRY, DAILY, daily)
+  DSW_DAILY_ARRAYS(DSW_KIND_ENTRY, DAILY, daily)
+};
+
+// currentField was set by key(), so each value is one table lookup then a store
+void DS_Weather::value(const char *val) {
+
+  if (currentField == DSW_FIELD_NONE) return;
+
+  uint8_t section = (depth == 1) ? DSW_CURRENT : sectionOf(contextKey[1]);
+
+  // The aggregates and history see every value of their data points, stored or not
+  uint64_t bit = 1ULL << currentField;
+  if (bit & (aggregateFields | historyFields))
+  {
+    if (aggregateFields & bit) aggregate((depth == 4) ? dataIndex : 0, val);
+    if (historyFields & bit) snapshotValue(val);
+    if (unstoredFields & bit) return;
+  }
+
+  // A lazy view keeps the text, it is decoded when the sketch reads it. The previous
+  // value is not kept so it is always reported as changed
+  DSW_view *view = binding.view[section];
+  if (view)
+  {
+    view->store((depth == 4) ? dataIndex : DSW_VIEW_SCALARS, currentField, val);
+    changedFields |= bit;
+    return;
+  }
+
+  void *slot = binding.slot[currentField];
+  if (!slot) return;
+
+  // Array data, dataIndex is incremented as each element closes
+  // A streamed section has a single record so the index stays at 0
+  uint16_t i = 0;
+  if (depth == 4) {
+    if (streamSections & (1 << section)) changedFields |= bit; // No previous value
+    else {
+      i = dataIndex;
+      if (i >= binding.size[section]) return;
+      if (binding.records[section] && i >= *binding.records[section]) *binding.records[section] = i + 1;
+    }
+
+    // Compact struct arrays hold fixed point values and time offsets
+    if (binding.timeBase[section]) {
+      compactValue(section, slot, i, val);
+      return;
+    }
+  }
+
+  // Each store compares with the value held, see changes()
+  switch (fieldKind[currentField]) {
+    case DSW_KIND_TEXT:  update((String   *)slot + i, val); break;
+    case DSW_KIND_UNIX:  update((uint32_t *)slot + i, toUnsigned(val)); break;
+    case DSW_KIND_U16:   update((uint16_t *)slot + i, (uint16_t)toUnsigned(val)); break;
+    case DSW_KIND_PCT:   update((uint8_t  *)slot + i, toPercent(val)); break;
+    case DSW_KIND_ICON:
+    case DSW_KIND_PTYPE: update((uint8_t  *)slot + i, iconIndex(val)); break;
+    case DSW_KIND_FLOAT:
+    case DSW_KIND_TEMP:
+    case DSW_KIND_PRESS:
+    case DSW_KIND_RATE:
+    case DSW_KIND_ACCUM:
+    case DSW_KIND_SPEED: update((float    *)slot + i, decimalToFloat(val)); break;
+    default: break;
+  }
+}
+
+/***************************************************************************************
+** Function name:           update
+** Description:             Store a String value, the field is marked if it changed
+***************************************************************************************/
+void DS_Weather::update(String *p, const char *val)
+{
+  if (*p == val) return;
+  *p = val;
+  changedFields |= 1ULL << currentField;
+}
+
+/***************************************************************************************
+** Function name:           changes
+** Description:             Data points of a section that changed in the last forecast
+***************************************************************************************/
+uint32_t DS_Weather::changes(uint8_t section)
+{
+  static const uint8_t base[DSW_SECTIONS]  = { DSW_CURRENT_BASE, DSW_MINUTELY_BASE,
+                                               DSW_HOURLY_BASE, DSW_DAILY_BASE };
+  static const uint8_t count[DSW_SECTIONS] = { DSW_CURRENT_COUNT, DSW_MINUTELY_COUNT,
+                                               DSW_HOURLY_COUNT, DSW_DAILY_COUNT };
+
+  if (section >= DSW_SECTIONS) return 0;
+  return (uint32_t)(changedFields >> base[section]) & ((1UL << count[section]) - 1);
+}
+
+/***************************************************************************************
+** Function name:           bindWatched
+** Description:             Make sure the aggregate and history data points are parsed
+***************************************************************************************/
+// Called after the structs are bound
+void DS_Weather::bindWatched()
+{
+  aggregateFields = 0;
+  historyFields = 0;
+  unstoredFields = 0;
+  for (uint8_t section = 0; section < DSW_SECTIONS; section++) watchedEnd[section] = 0;
+
+  for (uint8_t a = 0; a < aggregateCount; a++) {
+    uint8_t field = aggregates[a].field;
+    if (field >= DSW_FIELD_COUNT) continue;
+
+    aggregateFields |= 1ULL << field;
+
+    // The whole array is needed if the count is 0
+    watchField(field, aggregates[a].count ? (uint32_t)aggregates[a].first + aggregates[a].count : 0xFFFF);
+  }
+
+  if (history) {
+    static const uint8_t current[] = {
+      DSW_FIELD_current_time, DSW_FIELD_current_temperature, DSW_FIELD_current_pressure,
+      DSW_FIELD_current_windSpeed, DSW_FIELD_current_windBearing,
+      DSW_FIELD_current_precipIntensity, DSW_FIELD_current_humidity,
+      DSW_FIELD_current_cloudCover, DSW_FIELD_current_precipProbability, DSW_FIELD_current_icon };
+    static const uint8_t hourly[] = {
+      DSW_FIELD_hourly_temperature, DSW_FIELD_hourly_precipIntensity, DSW_FIELD_hourly_precipProbability };
+
+    for (uint8_t f = 0; f < sizeof(current); f++) {
+      historyFields |= 1ULL << current[f];
+      watchField(current[f], 0);
+    }
+    if (historyHourly) for (uint8_t f = 0; f < sizeof(hourly); f++) {
+      historyFields |= 1ULL << hourly[f];
+      watchField(hourly[f], 1);
+    }
+  }
+}
+
+/***************************************************************************************
+** Function name:           watchField
+** Description:             Add a field to the binding so it is parsed
+***************************************************************************************/
+// A data point that is watched but not stored is added to the section fields so it is
+// requested and decoded, then value() drops it after the aggregates and history have it
+void DS_Weather::watchField(uint8_t field, uint32_t end)
+{
+  static const uint8_t base[DSW_SECTIONS] = { DSW_CURRENT_BASE, DSW_MINUTELY_BASE,
+                                              DSW_HOURLY_BASE, DSW_DAILY_BASE };
+
+  uint8_t section = fieldSection(field);
+  uint32_t bit = 1UL << (field - base[section]);
+
+  if (!(binding.fields[section] & bit)) unstoredFields |= 1ULL << field;
+  binding.fields[section] |= bit;
+
+  if (end > watchedEnd[section]) watchedEnd[section] = (end > 0xFFFF) ? 0xFFFF : end;
+}
+
+/***************************************************************************************
+** Function name:           aggregate
+** Description:             Add a value to the aggregates of the current field
+***************************************************************************************/
+void DS_Weather::aggregate(uint16_t i, const char *val)
+{
+  float x;
+  switch (fieldKind[currentField]) {
+    case DSW_KIND_UNIX:
+    case DSW_KIND_U16: x = toUnsigned(val); break;
+    case DSW_KIND_PCT: x = toPercent(val); break;
+    case DSW_KIND_TEXT:
+    case DSW_KIND_ICON:
+    case DSW_KIND_PTYPE: return;
+    default: x = decimalToFloat(val); break;
+  }
+
+  for (uint8_t a = 0; a < aggregateCount; a++) {
+    DSW_aggregate &g = aggregates[a];
+    if (g.field != currentField || i < g.first) continue;
+    if (g.count && i - g.first >= g.count) continue;
+
+    if (!g.n || x < g.min) { g.min = x; g.minIndex = i; }
+    if (!g.n || x > g.max) { g.max = x; g.maxIndex = i; }
+    g.sum += x;
+    g.n++;
+    if (g.crossIndex == DSW_NOT_FOUND && x >= g.threshold) g.crossIndex = i;
+  }
+}
+
+/***************************************************************************************
+** Function name:           fieldSection
+** Description:             Section of a field number
+***************************************************************************************/
+uint8_t DS_Weather::fieldSection(uint8_t field)
+{
+  if (field >= DSW_DAILY_BASE)    return DSW_DAILY;
+  if (field >= DSW_HOURLY_BASE)   return DSW_HOURLY;
+  if (field >= DSW_MINUTELY_BASE) return DSW_MINUTELY;
+  return DSW_CURRENT;
+}
+
+/***************************************************************************************
+** Function name:           snapshotValue
+** Description:             Store a value of the current field in the history snapshot
+***************************************************************************************/
+void DS_Weather::snapshotValue(const char *val)
+{
+  switch (currentField) {
+    case DSW_FIELD_current_time:              snapshot.time = toUnsigned(val); break;
+    case DSW_FIELD_current_temperature:       snapshot.temperature = roundedFixed(val, 2, -32767, 32767); break;
+    case DSW_FIELD_current_pressure:          snapshot.pressure = roundedFixed(val, 1, 0, 65535); break;
+    case DSW_FIELD_current_windSpeed:         snapshot.windSpeed = roundedFixed(val, 2, 0, 65535); break;
+    case DSW_FIELD_current_windBearing:       snapshot.windBearing = toUnsigned(val); break;
+    case DSW_FIELD_current_precipIntensity:   snapshot.precipIntensity = roundedFixed(val, 3, 0, 65535); break;
+    case DSW_FIELD_current_humidity:          snapshot.humidity = toPercent(val); break;
+    case DSW_FIELD_current_cloudCover:        snapshot.cloudCover = toPercent(val); break;
+    case DSW_FIELD_current_precipProbability: snapshot.precipProbability = toPercent(val); break;
+    case DSW_FIELD_current_icon:              snapshot.icon = iconIndex(val); break;
+    default: break;
+  }
+
+  // First hourly data point only
+  if (depth != 4 || dataIndex != 0) return;
+
+  switch (currentField) {
+    case DSW_FIELD_hourly_temperature:        snapshot.hourlyTemperature = roundedFixed(val, 2, -32767, 32767); break;
+    case DSW_FIELD_hourly_precipIntensity:    snapshot.hourlyPrecipIntensity = roundedFixed(val, 3, 0, 65535); break;
+    case DSW_FIELD_hourly_precipProbability:  snapshot.hourlyPrecipProbability = toPercent(val); break;
+    default: break;
+  }
+}
+
+/***************************************************************************************
+** Function name:           addSnapshot
+** Description:             Add the snapshot to the history after a successful parse
+***************************************************************************************/
+void DS_Weather::addSnapshot()
+{
+  if (history && snapshot.time) history->add(snapshot);
+}
+
+/***************************************************************************************
+** Function name:           compactValue
+** Description:             Store a value in a compact struct array, see DSW_Compact.h
+***************************************************************************************/
+void DS_Weather::compactValue(uint8_t section, void *slot, uint16_t i, const char *val)
+{
+  switch (fieldKind[currentField]) {
+    case DSW_KIND_UNIX:
+    {
+      // The first time received is the base for the section, others are offsets from it
+      uint32_t t = toUnsigned(val);
+      uint32_t &base = *binding.timeBase[section];
+      if (!(timeBaseSet & (1 << section))) {
+        if (base != t) timeBaseMoved |= (1 << section);
+        base = t;
+        timeBaseSet |= (1 << section);
+      }
+
+      // If the base moved every time changed, even if its offset is the same
+      if (timeBaseMoved & (1 << section)) changedFields |= 1ULL << currentField;
+
+      if (section == DSW_HOURLY)
+        update((DSW_HOURLY_TIME_T *)slot + i, (DSW_HOURLY_TIME_T)clampedOffset(t, base, DSW_HOURLY_TIME_STEP, 0xFE));
+      else if (section == DSW_MINUTELY)
+        update((DSW_MINUTELY_TIME_T *)slot + i, (DSW_MINUTELY_TIME_T)clampedOffset(t, base, DSW_MINUTELY_TIME_STEP, 0xFE));
+      else
+        update((DSW_DAILY_TIME_T *)slot + i, (DSW_DAILY_TIME_T)clampedOffset(t, base, DSW_DAILY_TIME_STEP, 0xFFFE));
+      break;
+    }
+    case DSW_KIND_TEMP:  update((int16_t  *)slot + i, (int16_t)roundedFixed(val, 2, -32767, 32767)); break;
+    case DSW_KIND_PRESS: update((uint16_t *)slot + i, (uint16_t)roundedFixed(val, 1, 0, 65535)); break;
+    case DSW_KIND_RATE:  update((uint16_t *)slot + i, (uint16_t)roundedFixed(val, 3, 0, 65535)); break;
+    case DSW_KIND_ACCUM:
+    case DSW_KIND_SPEED: update((uint16_t *)slot + i, (uint16_t)roundedFixed(val, 2, 0, 65535)); break;
+    case DSW_KIND_FLOAT: update((float    *)slot + i, decimalToFloat(val)); break;
+    case DSW_KIND_TEXT:
+      // The pool is rebuilt for each forecast so an index can not be compared
+      ((uint8_t *)slot)[i] = binding.textPool ? binding.textPool->add(val) : DSW_TEXT_NONE;
+      changedFields |= 1ULL << currentField;
+      break;
+    case DSW_KIND_U16:   update((uint16_t *)slot + i, (uint16_t)toUnsigned(val)); break;
+    case DSW_KIND_PCT:   update((uint8_t  *)slot + i, toPercent(val)); break;
+    case DSW_KIND_ICON:
+    case DSW_KIND_PTYPE: update((uint8_t  *)slot + i, iconIndex(val)); break;
+    default: break;
+  }
+}
+
+/***************************************************************************************
+** Function name:           roundedFixed
+** Description:             Fixed point value rounded to the last decimal place and clamped
+***************************************************************************************/
+int32_t DS_Weather::roundedFixed(const char *val, uint8_t decimals, int32_t min, int32_t max)
+{
+  int32_t x = fixedPoint(val, decimals + 1);
+  x = (x + (x < 0 ? -5 : 5)) / 10;
+  return (x < min) ? min : (x > max) ? max : x;
+}
+
+/***************************************************************************************
+** Function name:           clampedOffset
+** Description:             Time offset from base in steps, rounded and limited to max
+***************************************************************************************/
+uint32_t DS_Weather::clampedOffset(uint32_t t, uint32_t base, uint32_t step, uint32_t max)
+{
+  if (t < base) return 0;
+  uint32_t offset = (t - base + step / 2) / step;
+  return (offset > max) ? max : offset;
+}
+
+/***************************************************************************************
+** Function name:           DSW_text_pool::add
+** Description:             Index of a text in the pool, the text is added if not found
+***************************************************************************************/
+uint8_t DSW_text_pool::add(const char *val)
+{
+  // Few different texts are expected, so a linear search is fast enough
+  for (uint8_t i = 0; i < texts; i++)
+    if (!strcmp(pool + offset[i], val)) return i;
+
+  uint16_t length = strlen(val) + 1;
+  if (texts >= n || texts >= DSW_TEXT_NONE || (uint32_t)used + length > poolBytes)
+  {
+    dropped = true;
+    return DSW_TEXT_NONE;
+  }
+
+  offset[texts] = used;
+  memcpy(pool + used, val, length);
+  used += length;
+
+  return texts++;
+}
+
+/***************************************************************************************
+** Function name:           DSW_text_pool::text
+** Description:             Text for an index, "" if not held
+***************************************************************************************/
+const char *DSW_text_pool::text(uint8_t index) const
+{
+  if (index >= texts) return "";
+  return pool + offset[index];
+}
+
+/***************************************************************************************
+** Function name:           DSW_text_pool::clear
+** Description:             Empty the pool ready for a new forecast
+***************************************************************************************/
+void DSW_text_pool::clear()
+{
+  used = 0;
+  texts = 0;
+  dropped = false;
+}
+
+/***************************************************************************************
+** Function name:           DSW_history::add
+** Description:             Add a snapshot, replacing the oldest if full
+***************************************************************************************/
+void DSW_history::add(const DSW_snapshot &snapshot)
+{
+  ring[head] = snapshot;
+  if (++head >= n) head = 0;
+  if (count < n) count++;
+}
+
+/***************************************************************************************
+** Function name:           DSW_history::value
+** Description:             Snapshot value in the usual units
+***************************************************************************************/
+float DSW_history::value(const DSW_snapshot &s, uint8_t id)
+{
+  switch (id) {
+    case DSW_HISTORY_temperature:             return s.temperature / 100.0f;
+    case DSW_HISTORY_pressure:                return s.pressure / 10.0f;
+    case DSW_HISTORY_windSpeed:               return s.windSpeed / 100.0f;
+    case DSW_HISTORY_windBearing:             return s.windBearing;
+    case DSW_HISTORY_precipIntensity:         return s.precipIntensity / 1000.0f;
+    case DSW_HISTORY_humidity:                return s.humidity;
+    case DSW_HISTORY_cloudCover:              return s.cloudCover;
+    case DSW_HISTORY_precipProbability:       return s.precipProbability;
+    case DSW_HISTORY_hourlyTemperature:       return s.hourlyTemperature / 100.0f;
+    case DSW_HISTORY_hourlyPrecipIntensity:   return s.hourlyPrecipIntensity / 1000.0f;
+    case DSW_HISTORY_hourlyPrecipProbability: return s.hourlyPrecipProbability;
+    default:                                  return 0;
+  }
+}
+
+/***************************************************************************************
+** Function name:           DSW_history::stats
+** Description:             Minimum, maximum and trend of a value over a time window
+***************************************************************************************/
+bool DSW_history::stats(uint8_t id, uint32_t window, DSW_history_stats *st) const
+{
+  st->n = 0;
+  st->min = st->max = st->slope = 0;
+  if (!count) return false;
+
+  // Times are taken relative to the newest in hours, so the sums stay small
+  uint32_t newest = get(0).time;
+  float sx = 0, sy = 0, sxx = 0, sxy = 0;
+
+  for (uint16_t i = 0; i < count; i++) {
+    const DSW_snapshot &s = get(i);
+    if (newest - s.time > window) break;
+
+    float x = -(float)(newest - s.time) / 3600.0f;
+    float y = value(s, id);
+
+    if (!st->n || y < st->min) st->min = y;
+    if (!st->n || y > st->max) st->max = y;
+    sx += x; sy += y; sxx += x * x; sxy += x * y;
+    st->n++;
+  }
+
+  float d = st->n * sxx - sx * sx;
+  if (st->n > 1 && d > 0) st->slope = (st->n * sxy - sx * sy) / d;
+
+  return true;
+}
+
+// Serialized layout: header then the snapshots oldest first
+#define DSW_HISTORY_MAGIC   0x48575344UL // "DSWH"
+#define DSW_HISTORY_VERSION 1
+
+typedef struct dsw_history_header_t {
+  uint32_t magic;
+  uint8_t  version;
+  uint8_t  snapshotSize; // sizeof(DSW_snapshot), a different layout is rejected
+  uint16_t count;
+} dsw_history_header_t;
+
+/***************************************************************************************
+** Function name:           DSW_history::serializedSize
+** Description:             Bytes needed by serialize()
+***************************************************************************************/
+size_t DSW_history::serializedSize() const
+{
+  return sizeof(dsw_history_header_t) + count * sizeof(DSW_snapshot);
+}
+
+/***************************************************************************************
+** Function name:           DSW_history::serialize
+** Description:             Copy the history to a byte array
+***************************************************************************************/
+size_t DSW_history::serialize(uint8_t *buffer, size_t length) const
+{
+  size_t bytes = serializedSize();
+  if (!buffer || length < bytes) return 0;
+
+  dsw_history_header_t header = { DSW_HISTORY_MAGIC, DSW_HISTORY_VERSION, sizeof(DSW_snapshot), count };
+  memcpy(buffer, &header, sizeof(header));
+  buffer += sizeof(header);
+
+  for (uint16_t i = count; i > 0; i--) {
+    memcpy(buffer, &get(i - 1), sizeof(DSW_snapshot));
+    buffer += sizeof(DSW_snapshot);
+  }
+
+  return bytes;
+}
+
+/***************************************************************************************
+** Function name:           DSW_history::deserialize
+** Description:             Restore a history copied by serialize()
+***************************************************************************************/
+// If the saved history is longer than this one the oldest snapshots are dropped
+bool DSW_history::deserialize(const uint8_t *buffer, size_t length)
+{
+  clear();
+
+  dsw_history_header_t header;
+  if (!buffer || length < sizeof(header)) return false;
+  memcpy(&header, buffer, sizeof(header));
+
+  if (header.magic != DSW_HISTORY_MAGIC || header.version != DSW_HISTORY_VERSION ||
+      header.snapshotSize != sizeof(DSW_snapshot) ||
+      length < sizeof(header) + header.count * sizeof(DSW_snapshot)) return false;
+
+  buffer += sizeof(header);
+  DSW_snapshot s;
+  for (uint16_t i = 0; i < header.count; i++) {
+    memcpy(&s, buffer, sizeof(s));
+    buffer += sizeof(s);
+    add(s);
+  }
+
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate tables
+** Description:             Deflate length and distance codes, RFC 1951
+***************************************************************************************/
+static const uint16_t dsw_length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23,
+  27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t  dsw_length_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t dsw_dist_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+  193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t  dsw_dist_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
+  8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Order the code length code lengths are sent in
+static const uint8_t  dsw_lenlen_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3,
+  13, 2, 14, 1, 15 };
+
+#define DSW_GZIP_FEXTRA   0x04
+#define DSW_GZIP_FNAME    0x08
+#define DSW_GZIP_FCOMMENT 0x10
+#define DSW_GZIP_FHCRC    0x02
+#define DSW_GZIP_SKIP     0x80 // Skipping the FEXTRA data
+
+/***************************************************************************************
+** Function name:           DSW_inflate::begin
+** Description:             Start a new stream
+***************************************************************************************/
+void DSW_inflate::begin()
+{
+  next      = nullptr;
+  avail     = 0;
+  bitBuffer = 0;
+  bitCount  = 0;
+
+  state     = DSW_INF_HEADER;
+  fault     = DSW_INFLATE_OK;
+  last      = false;
+  format    = 0;
+  flags     = 0;
+  step      = 0;
+  length    = 0;
+  symbol    = 0;
+  distance  = 0;
+  furthest  = 0;
+
+  received  = 0;
+  produced  = 0;
+  isize     = 0;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::inflate
+** Description:             Decompress a block of the stream
+***************************************************************************************/
+// Every step checks its input bits are available before taking them, or keeps what it
+// has taken in the state, so the stream can be split between blocks at any byte. Output
+// stops at the end of the window so it is returned as one contiguous run.
+int DSW_inflate::inflate(const uint8_t *in, int count, const uint8_t **out, int *outCount)
+{
+  next  = in;
+  avail = count;
+
+  uint32_t first = produced;
+  bool     full  = false; // Output has reached the end of the window
+
+  while (!full)
+  {
+    switch (state)
+    {
+      case DSW_INF_HEADER:
+        if (!header()) goto stop;
+        break;
+
+      case DSW_INF_BLOCK:
+        if (last)
+        {
+          bits(bitCount & 7); // Trailer is byte aligned
+          step = 0;
+          state = DSW_INF_TRAILER;
+          break;
+        }
+        if (!need(3)) goto stop;
+        last = bits(1);
+        switch (bits(2))
+        {
+          case 0:  bits(bitCount & 7); state = DSW_INF_STORED; break;
+          case 1:  fixed();            state = DSW_INF_CODES;  break;
+          case 2:                      state = DSW_INF_TABLE;  break;
+          default: fail(DSW_INFLATE_FORMAT); goto stop;
+        }
+        break;
+
+      case DSW_INF_STORED:
+      {
+        if (!need(32)) goto stop;
+        length = bits(16);
+        uint16_t check = bits(16);
+        if ((uint16_t)~length != check) { fail(DSW_INFLATE_FORMAT); goto stop; }
+        state = DSW_INF_COPY;
+        break;
+      }
+
+      case DSW_INF_COPY:
+        while (length)
+        {
+          if (!need(8)) goto stop;
+          length--;
+          if (put(bits(8))) { full = true; break; }
+        }
+        if (!length) state = DSW_INF_BLOCK;
+        break;
+
+      case DSW_INF_TABLE:
+        if (!need(14)) goto stop;
+        nlen  = bits(5) + 257;
+        ndist = bits(5) + 1;
+        ncode = bits(4) + 4;
+        if (nlen > 286 || ndist > 30) { fail(DSW_INFLATE_FORMAT); goto stop; }
+        memset(lengths, 0, 19);
+        step = 0;
+        state = DSW_INF_LENLENS;
+        break;
+
+      case DSW_INF_LENLENS:
+        while (step < ncode)
+        {
+          if (!need(3)) goto stop;
+          lengths[dsw_lenlen_order[step++]] = bits(3);
+        }
+        // The code length code is held in the distance code until the lengths are read
+        if (!build(distCount, distSymbol, lengths, 19)) { fail(DSW_INFLATE_FORMAT); goto stop; }
+        step = 0;
+        symbol = 0;
+        state = DSW_INF_CODELENS;
+        break;
+
+      case DSW_INF_CODELENS:
+        while (step < nlen + ndist)
+        {
+          // symbol holds a repeat code (16 to 18) waiting for its extra bits
+          if (!symbol)
+          {
+            int s = decode(distCount, distSymbol);
+            if (s == -1) goto stop;
+            if (s < 0) { fail(DSW_INFLATE_FORMAT); goto stop; }
+            if (s < 16) { lengths[step++] = s; continue; }
+            symbol = s;
+          }
+
+          uint8_t extra = (symbol == 16) ? 2 : (symbol == 17) ? 3 : 7;
+          if (!need(extra)) goto stop;
+
+          uint8_t  value  = 0;
+          uint16_t repeat;
+          if (symbol == 16)
+          {
+            if (!step) { fail(DSW_INFLATE_FORMAT); goto stop; }
+            value  = lengths[step - 1];
+            repeat = 3 + bits(2);
+          }
+          else if (symbol == 17) repeat = 3 + bits(3);
+          else                   repeat = 11 + bits(7);
+          symbol = 0;
+
+          if (step + repeat > nlen + ndist) { fail(DSW_INFLATE_FORMAT); goto stop; }
+          while (repeat--) lengths[step++] = value;
+        }
+
+        // The end of block code must be present
+        if (!lengths[256] ||
+            !build(lenCount, lenSymbol, lengths, nlen) ||
+            !build(distCount, distSymbol, lengths + nlen, ndist)) { fail(DSW_INFLATE_FORMAT); goto stop; }
+        state = DSW_INF_CODES;
+        break;
+
+      case DSW_INF_CODES:
+        for (;;)
+        {
+          int s = decode(lenCount, lenSymbol);
+          if (s == -1) goto stop;
+          if (s < 0 || s > 285) { fail(DSW_INFLATE_FORMAT); goto stop; }
+          if (s < 256)
+          {
+            if (put(s)) { full = true; break; }
+            continue;
+          }
+          if (s == 256) state = DSW_INF_BLOCK;
+          else
+          {
+            symbol = s - 257;
+            state = DSW_INF_LENGTH;
+          }
+          break;
+        }
+        break;
+
+      case DSW_INF_LENGTH:
+        if (!need(dsw_length_extra[symbol])) goto stop;
+        length = dsw_length_base[symbol] + bits(dsw_length_extra[symbol]);
+        state = DSW_INF_DIST;
+        break;
+
+      case DSW_INF_DIST:
+      {
+        int s = decode(distCount, distSymbol);
+        if (s == -1) goto stop;
+        if (s < 0 || s > 29) { fail(DSW_INFLATE_FORMAT); goto stop; }
+        symbol = s;
+        state = DSW_INF_DISTEXT;
+        break;
+      }
+
+      case DSW_INF_DISTEXT:
+        if (!need(dsw_dist_extra[symbol])) goto stop;
+        distance = dsw_dist_base[symbol] + bits(dsw_dist_extra[symbol]);
+        if (distance > furthest) furthest = distance;
+        if (distance > produced) { fail(DSW_INFLATE_FORMAT); goto stop; }
+        if (distance > windowSize()) { fail(DSW_INFLATE_WINDOW); goto stop; }
+        state = DSW_INF_MATCH;
+        break;
+
+      case DSW_INF_MATCH:
+        while (length)
+        {
+          length--;
+          if (put(window[(produced - distance) & mask])) { full = true; break; }
+        }
+        if (!length) state = DSW_INF_CODES;
+        break;
+
+      case DSW_INF_TRAILER:
+        if (!trailer()) goto stop;
+        break;
+
+      default: // DSW_INF_DONE or DSW_INF_FAILED
+        goto stop;
+    }
+  }
+
+stop:
+  *out      = window + (first & mask);
+  *outCount = produced - first;
+
+  received += count - avail;
+  return count - avail;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::need
+** Description:             Fill the bit buffer to n bits, false if the input ran out
+***************************************************************************************/
+bool DSW_inflate::need(uint8_t n)
+{
+  while (bitCount < n)
+  {
+    if (avail <= 0) return false;
+    bitBuffer |= (uint32_t)*next++ << bitCount;
+    bitCount += 8;
+    avail--;
+  }
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::bits
+** Description:             Take n bits (up to 16) from the bit buffer
+***************************************************************************************/
+uint32_t DSW_inflate::bits(uint8_t n)
+{
+  uint32_t v = bitBuffer & ((1UL << n) - 1);
+  bitBuffer >>= n;
+  bitCount  -= n;
+  return v;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::decode
+** Description:             Decode a Huffman symbol, -1 if the input ran out, -2 if invalid
+***************************************************************************************/
+// The code is read a bit at a time, the bits are only taken when a symbol is found
+int DSW_inflate::decode(const uint16_t *count, const uint16_t *symbol)
+{
+  int code = 0, first = 0, index = 0;
+
+  for (uint8_t len = 1; len < 16; len++)
+  {
+    if (!need(len)) return -1;
+    code |= (bitBuffer >> (len - 1)) & 1;
+    int n = count[len];
+    if (code - first < n)
+    {
+      bits(len);
+      return symbol[index + code - first];
+    }
+    index += n;
+    first += n;
+    first <<= 1;
+    code  <<= 1;
+  }
+
+  return -2;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::build
+** Description:             Build a canonical Huffman code from the code lengths
+***************************************************************************************/
+// Returns false if the code is over subscribed, incomplete codes are allowed
+bool DSW_inflate::build(uint16_t *count, uint16_t *symbol, const uint8_t *lengths, uint16_t n)
+{
+  uint16_t offset[16];
+
+  memset(count, 0, 16 * sizeof(uint16_t));
+  for (uint16_t i = 0; i < n; i++) count[lengths[i]]++;
+  count[0] = 0;
+
+  int left = 1;
+  for (uint8_t len = 1; len < 16; len++)
+  {
+    left = (left << 1) - count[len];
+    if (left < 0) return false;
+  }
+
+  offset[1] = 0;
+  for (uint8_t len = 1; len < 15; len++) offset[len + 1] = offset[len] + count[len];
+
+  for (uint16_t i = 0; i < n; i++)
+  {
+    if (lengths[i]) symbol[offset[lengths[i]]++] = i;
+  }
+
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::fixed
+** Description:             Set the fixed Huffman codes
+***************************************************************************************/
+void DSW_inflate::fixed()
+{
+  uint16_t i = 0;
+  for (; i < 144; i++) lengths[i] = 8;
+  for (; i < 256; i++) lengths[i] = 9;
+  for (; i < 280; i++) lengths[i] = 7;
+  for (; i < 288; i++) lengths[i] = 8;
+  build(lenCount, lenSymbol, lengths, 288);
+
+  for (i = 0; i < 30; i++) lengths[i] = 5;
+  build(distCount, distSymbol, lengths, 30);
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::header
+** Description:             Read the gzip or zlib header, false if more input is needed
+***************************************************************************************/
+// A stream that starts with neither header is taken to be raw deflate
+bool DSW_inflate::header()
+{
+  if (step == 0)
+  {
+    if (!need(16)) return false;
+    uint8_t b0 = bitBuffer & 0xFF;
+    uint8_t b1 = (bitBuffer >> 8) & 0xFF;
+
+    if (b0 == 0x1F && b1 == 0x8B)
+    {
+      format = 1;
+      bits(16);
+      step = 2;
+    }
+    else if ((b0 & 0x0F) == 8 && ((b0 << 8) | b1) % 31 == 0)
+    {
+      // zlib, a preset dictionary is not supported
+      if (b1 & 0x20) return fail(DSW_INFLATE_FORMAT);
+      format = 2;
+      bits(16);
+      state = DSW_INF_BLOCK;
+      return true;
+    }
+    else
+    {
+      format = 0;
+      state = DSW_INF_BLOCK;
+      return true;
+    }
+  }
+
+  // gzip fixed part: ID1 ID2 CM FLG MTIME(4) XFL OS
+  while (step < 10)
+  {
+    if (!need(8)) return false;
+    uint8_t b = bits(8);
+    if (step == 2 && b != 8) return fail(DSW_INFLATE_FORMAT);
+    if (step == 3) flags = b;
+    step++;
+  }
+
+  if (flags & DSW_GZIP_FEXTRA)
+  {
+    if (!need(16)) return false;
+    length = bits(16);
+    flags = (flags & ~DSW_GZIP_FEXTRA) | DSW_GZIP_SKIP;
+  }
+
+  while ((flags & DSW_GZIP_SKIP) && length)
+  {
+    if (!need(8)) return false;
+    bits(8);
+    length--;
+  }
+  flags &= ~DSW_GZIP_SKIP;
+
+  // Zero terminated file name and comment
+  while (flags & DSW_GZIP_FNAME)
+  {
+    if (!need(8)) return false;
+    if (!bits(8)) flags &= ~DSW_GZIP_FNAME;
+  }
+
+  while (flags & DSW_GZIP_FCOMMENT)
+  {
+    if (!need(8)) return false;
+    if (!bits(8)) flags &= ~DSW_GZIP_FCOMMENT;
+  }
+
+  if (flags & DSW_GZIP_FHCRC)
+  {
+    if (!need(16)) return false;
+    bits(16);
+  }
+
+  flags = 0;
+  state = DSW_INF_BLOCK;
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_inflate::trailer
+** Description:             Read the gzip or zlib trailer, false if more input is needed
+***************************************************************************************/
+bool DSW_inflate::trailer()
+{
+  // gzip CRC32 and ISIZE, zlib Adler-32, nothing for raw deflate
+  uint8_t size = (format == 1) ? 8 : (format == 2) ? 4 : 0;
+
+  while (step < size)
+  {
+    if (!need(8)) return false;
+    uint32_t b = bits(8);
+    if (step >= 4) isize |= b << (8 * (step - 4));
+    step++;
+  }
+
+  if (format == 1 && isize != produced) return fail(DSW_INFLATE_LENGTH);
+
+  state = DSW_INF_DONE;
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_pool::setLocation
+** Description:             Set the coordinates of location i
+***************************************************************************************/
+void DSW_pool::setLocation(uint8_t i, String latitude, String longitude)
+{
+  if (i >= siteCount) return;
+
+  site[i].latitude  = latitude;
+  site[i].longitude = longitude;
+}
+
+/***************************************************************************************
+** Function name:           DSW_pool::setAggregates etc
+** Description:             Set the statistics kept for a location
+***************************************************************************************/
+// They are handed to the context that fetches the location
+void DSW_pool::setAggregates(uint8_t i, DSW_aggregate *list, uint8_t count)
+{
+  if (i >= siteCount) return;
+
+  site[i].aggregates     = list;
+  site[i].aggregateCount = list ? count : 0;
+}
+
+void DSW_pool::setHistory(uint8_t i, DSW_history *history, bool hourly)
+{
+  if (i >= siteCount) return;
+
+  site[i].history       = history;
+  site[i].historyHourly = hourly;
+}
+
+/***************************************************************************************
+** Function name:           DSW_pool::setLimit
+** Description:             Set the number of requests in progress at once
+***************************************************************************************/
+// Requests already running on contexts above the limit are left to finish
+void DSW_pool::setLimit(uint8_t limit)
+{
+  if (limit < 1) limit = 1;
+  if (limit > contextCount) limit = contextCount;
+  this->limit = limit;
+}
+
+/***************************************************************************************
+** Function name:           DSW_pool::begin
+** Description:             Queue a request for every location
+***************************************************************************************/
+bool DSW_pool::begin(String api_key, String units, String language)
+{
+  for (uint8_t c = 0; c < contextCount; c++)
+  {
+    if (pool[c].location != DSW_POOL_NONE) return false;
+  }
+
+  this->api_key  = api_key;
+  this->units    = units;
+  this->language = language;
+
+  for (uint8_t i = 0; i < siteCount; i++) site[i].state = DSW_FETCH_IDLE;
+
+  next = 0;
+  rounds++;
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_pool::poll
+** Description:             Advance the requests in progress and start queued ones
+***************************************************************************************/
+// Each context in progress does one step (see DS_Weather::poll()), so a slow response
+// does not hold up the others. A finished context takes the next queued location.
+uint8_t DSW_pool::poll()
+{
+  uint8_t busy = 0;
+
+  for (uint8_t c = 0; c < contextCount; c++)
+  {
+    DSW_pool_context &r = pool[c];
+
+    if (r.location != DSW_POOL_NONE)
+    {
+      uint8_t state = r.dsw.poll();
+      site[r.location].state = state;
+      if (state < DSW_FETCH_DONE) { busy++; continue; }
+
+      if (state == DSW_FETCH_DONE) finish(r.dsw, r.location);
+      site[r.location].partial = state != DSW_FETCH_DONE;
+      r.location = DSW_POOL_NONE;
+    }
+
+    // Skip locations with no coordinates, they stay DSW_FETCH_IDLE
+    while (next < siteCount && site[next].latitude.length() == 0) next++;
+
+    if (c < limit && next < siteCount)
+    {
+      // The context's statistics are those of the location it fetches
+      DSW_location &s = site[next];
+      r.dsw.setAggregates(s.aggregates, s.aggregateCount);
+      r.dsw.setHistory(s.history, s.historyHourly);
+
+      if (start(r.dsw, next))
+      {
+        site[next].state = DSW_FETCH_CONNECT;
+        r.location = next;
+        busy++;
+      }
+      else
+      {
+        site[next].state   = DSW_FETCH_FAILED;
+        site[next].partial = true; // The data element counts were cleared
+      }
+      next++;
+    }
+  }
+
+  while (next < siteCount && site[next].latitude.length() == 0) next++;
+
+  return busy + (siteCount - next);
+}
+
+/***************************************************************************************
+** Function name:           DSW_pool::cancel
+** Description:             Stop the round, locations not finished are failed
+***************************************************************************************/
+void DSW_pool::cancel()
+{
+  for (uint8_t c = 0; c < contextCount; c++)
+  {
+    DSW_pool_context &r = pool[c];
+    if (r.location == DSW_POOL_NONE) continue;
+
+    r.dsw.cancelForecast();
+    site[r.location].state   = DSW_FETCH_FAILED;
+    site[r.location].partial = true;
+    r.location = DSW_POOL_NONE;
+  }
+
+  for (; next < siteCount; next++)
+  {
+    if (site[next].latitude.length()) site[next].state = DSW_FETCH_FAILED;
+  }
+}
+
+#if defined(ESP32) || defined(DSW_STD_THREAD)
+
+/***************************************************************************************
+** Function name:           DSW_worker::start
+** Description:             Start the background fetch task
+***************************************************************************************/
+bool DSW_worker::start(uint32_t interval)
+{
+  if (active) return false;
+
+  this->interval = interval * 1000UL;
+  stopping   = false;
+  refreshNow = true;
+  active     = true;
+
+#ifdef DSW_STD_THREAD
+  task = std::thread(entry, this);
+#else
+  if (xTaskCreatePinnedToCore(entry, "DSW_fetch", DSW_TASK_STACK, this,
+                              DSW_TASK_PRIORITY, nullptr, DSW_TASK_CORE) != pdPASS)
+  {
+    active = false;
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_worker::end
+** Description:             Stop the background fetch task
+***************************************************************************************/
+void DSW_worker::end()
+{
+  if (!active) return;
+
+  stopping = true;
+
+#ifdef DSW_STD_THREAD
+  task.join();
+#else
+  while (active) delay(10); // The task deletes itself
+#endif
+}
+
+/***************************************************************************************
+** Function name:           DSW_worker::refresh
+** Description:             Fetch now instead of at the next interval
+***************************************************************************************/
+void DSW_worker::refresh()
+{
+  refreshNow = true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_worker::acquireSet
+** Description:             Set of the newest forecast with its reader count raised
+***************************************************************************************/
+// The count is raised before front is checked again, so once the task has seen no
+// readers of the other set after a swap, no reader can start using it
+int8_t DSW_worker::acquireSet()
+{
+  if (!published) return -1;
+
+  for (;;)
+  {
+    uint32_t set = front;
+    readers[set]++;
+    if (front == set) return set;
+    readers[set]--;
+  }
+}
+
+/***************************************************************************************
+** Function name:           DSW_worker::entry
+** Description:             Task function
+***************************************************************************************/
+void DSW_worker::entry(void *worker)
+{
+  ((DSW_worker *)worker)->run();
+
+#ifndef DSW_STD_THREAD
+  vTaskDelete(nullptr);
+#endif
+}
+
+/***************************************************************************************
+** Function name:           DSW_worker::run
+** Description:             Fetch into the set the sketch is not reading, then swap
+***************************************************************************************/
+void DSW_worker::run()
+{
+  uint32_t last = millis();
+
+  while (!stopping)
+  {
+    if (refreshNow || millis() - last >= interval)
+    {
+      refreshNow = false;
+      last = millis();
+
+      // The first fetch fills set 1, so set 0 is never read before it is filled
+      uint32_t set = front ^ 1;
+
+      // Wait for readers still using the forecast before last
+      while (readers[set] && !stopping) delay(1);
+
+      if (!stopping)
+      {
+        if (fetch(set))
+        {
+          front = set;
+          published++;
+        }
+        else failed++;
+      }
+    }
+
+#ifdef DSW_STD_THREAD
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+#else
+    delay(100);
+#endif
+  }
+
+  active = false;
+}
+
+/***************************************************************************************
+** Function name:           DSW_ring::begin
+** Description:             Empty the ring and clear the counts
+***************************************************************************************/
+void DSW_ring::begin()
+{
+  head  = 0;
+  tail  = 0;
+  ended = false;
+  shut  = false;
+
+  written    = 0;
+  highWater  = 0;
+  fullCount  = 0;
+  emptyCount = 0;
+}
+
+/***************************************************************************************
+** Function name:           DSW_ring::write
+** Description:             Copy in as much as fits, returns the bytes written
+***************************************************************************************/
+// The bytes are copied before head is moved on (release), so the consumer never sees
+// an index past data that is not there yet
+uint32_t DSW_ring::write(const uint8_t *data, uint32_t count)
+{
+  uint32_t in = head.load(std::memory_order_relaxed);
+  uint32_t free = space();
+  if (count > free) count = free;
+
+  uint32_t at = in & mask;
+  uint32_t run = mask + 1 - at; // Bytes before the end of the buffer
+  if (run > count) run = count;
+  memcpy(buffer + at, data, run);
+  memcpy(buffer, data + run, count - run);
+
+  head.store(in + count, std::memory_order_release);
+
+  written += count;
+  uint32_t used = mask + 1 - free + count;
+  if (used > highWater) highWater = used;
+
+  return count;
+}
+
+/***************************************************************************************
+** Function name:           DSW_ring::peek
+** Description:             Bytes that can be read in place, up to the buffer end
+***************************************************************************************/
+uint32_t DSW_ring::peek(const uint8_t **data) const
+{
+  uint32_t out = tail.load(std::memory_order_relaxed);
+  uint32_t count = head.load(std::memory_order_acquire) - out;
+
+  uint32_t at = out & mask;
+  if (count > mask + 1 - at) count = mask + 1 - at;
+
+  *data = buffer + at;
+  return count;
+}
+
+/***************************************************************************************
+** Function name:           DSW_ring::waitForSpace etc
+** Description:             Wait for the other task, the waits are counted
+***************************************************************************************/
+void DSW_ring::waitForSpace()
+{
+  fullCount++;
+  pause();
+}
+
+void DSW_ring::waitForData()
+{
+  emptyCount++;
+  pause();
+}
+
+// A FreeRTOS task of the same priority spinning on taskYIELD() would starve the idle
+// task and trip the watchdog, so a tick is given up
+void DSW_ring::pause()
+{
+#ifdef DSW_STD_THREAD
+  std::this_thread::yield();
+#else
+  delay(1);
+#endif
+}
+
+#endif // ESP32 or DSW_STD_THREAD
+
+/***************************************************************************************
+** Function name:           DSW_view::bind
+** Description:             Clear a lazy view and bind it to a section
+***************************************************************************************/
+void DSW_view::bind(dsw_binding_t &b, uint32_t fields)
+{
+  start();
+
+  b.fields[section] = fields;
+  b.size[section] = n;
+  b.view[section] = this;
+}
+
+/***************************************************************************************
+** Function name:           DSW_view::start
+** Description:             Empty the view ready for a new response
+***************************************************************************************/
+void DSW_view::start()
+{
+  used = 0;
+  records = 0;
+  scalars = DSW_VIEW_NONE;
+  openRecord = DSW_VIEW_NONE;
+  dropped = false;
+
+  for (uint16_t i = 0; i < n; i++) record[i] = DSW_VIEW_NONE;
+  for (uint8_t i = 0; i < cacheSize; i++) cache[i].record = DSW_VIEW_NONE;
+  cacheNext = 0;
+}
+
+/***************************************************************************************
+** Function name:           DSW_view::store
+** Description:             Copy the text of a value to the pool
+***************************************************************************************/
+// The values of a record are stored together, a DSW_VIEW_END byte closes each record
+void DSW_view::store(uint16_t i, uint8_t field, const char *val)
+{
+  // Once full nothing more is stored, so the records kept are complete
+  if (dropped || (i != DSW_VIEW_SCALARS && i >= n)) return;
+
+  uint16_t length = strlen(val) + 2; // Field byte, text and terminating null
+  bool newRecord = (i != openRecord);
+  if (newRecord && openRecord != DSW_VIEW_NONE) length++;
+
+  if ((uint32_t)used + length > poolBytes)
+  {
+    dropped = true;
+    return;
+  }
+
+  if (newRecord)
+  {
+    if (openRecord != DSW_VIEW_NONE) pool[used++] = DSW_VIEW_END;
+    if (i == DSW_VIEW_SCALARS) scalars = used;
+    else
+    {
+      record[i] = used;
+      if (i >= records) records = i + 1;
+    }
+    openRecord = i;
+  }
+
+  pool[used++] = field;
+  length = strlen(val) + 1;
+  memcpy(pool + used, val, length);
+  used += length;
+}
+
+/***************************************************************************************
+** Function name:           DSW_view::find
+** Description:             Find the text of a field in the pool, nullptr if not stored
+***************************************************************************************/
+const char *DSW_view::find(uint16_t i, uint8_t field)
+{
+  uint16_t offset = scalars;
+  if (i != DSW_VIEW_SCALARS)
+  {
+    if (i >= records) return nullptr;
+    offset = record[i];
+  }
+  if (offset == DSW_VIEW_NONE) return nullptr;
+
+  const char *p   = pool + offset;
+  const char *end = pool + used;
+
+  while (p < end && (uint8_t)*p != DSW_VIEW_END)
+  {
+    if ((uint8_t)*p == field) return p + 1;
+    p += strlen(p + 1) + 2;
+  }
+
+  return nullptr;
+}
+
+/***************************************************************************************
+** Function name:           DSW_view::text
+** Description:             Text of a field, "" if not received
+***************************************************************************************/
+const char *DSW_view::text(uint16_t i, uint8_t field)
+{
+  const char *val = find(i, field);
+  return val ? val : "";
+}
+
+/***************************************************************************************
+** Function name:           DSW_view::decode
+** Description:             Decode a field with the same conversion as value()
+***************************************************************************************/
+uint32_t DSW_view::decode(uint16_t i, uint8_t field, uint8_t kind)
+{
+  for (uint8_t c = 0; c < cacheSize; c++)
+  {
+    if (cache[c].record == i && cache[c].field == field) return cache[c].value;
+  }
+
+  const char *val = find(i, field);
+
+  uint32_t result = 0;
+  if (!val)
+  {
+    if (kind == DSW_KIND_PTYPE) result = NO_VALUE; // Same defaults as the structs
+  }
+  else switch (kind) {
+    case DSW_KIND_UNIX:
+    case DSW_KIND_U16:   result = DS_Weather::toUnsigned(val); break;
+    case DSW_KIND_PCT:   result = DS_Weather::toPercent(val); break;
+    case DSW_KIND_ICON:
+    case DSW_KIND_PTYPE: result = DS_Weather::iconIndex(val); break;
+    case DSW_KIND_FLOAT:
+    case DSW_KIND_TEMP:
+    case DSW_KIND_PRESS:
+    case DSW_KIND_RATE:
+    case DSW_KIND_ACCUM:
+    case DSW_KIND_SPEED:
+    {
+      float f = DS_Weather::decimalToFloat(val);
+      memcpy(&result, &f, sizeof(result));
+      break;
+    }
+    default: break;
+  }
+
+  // Replace the cache entries in turn
+  if (cacheSize)
+  {
+    cache[cacheNext].record = i;
+    cache[cacheNext].field  = field;
+    cache[cacheNext].value  = result;
+    if (++cacheNext >= cacheSize) cacheNext = 0;
+  }
+
+  return result;
+}
+
+/***************************************************************************************
+** Function name:           DSW_arena
+** Description:             Constructors and destructor
+***************************************************************************************/
+DSW_arena::DSW_arena(void *buffer, size_t size)
+{
+  base  = (uint8_t *)buffer;
+  top   = base;
+  end   = base ? base + size : base;
+  owner = false;
+  cleanup = nullptr;
+}
+
+DSW_arena::DSW_arena(size_t size)
+{
+  base  = (uint8_t *)malloc(size);
+  top   = base;
+  end   = base ? base + size : base;
+  owner = true;
+  cleanup = nullptr;
+}
+
+DSW_arena::~DSW_arena()
+{
+  reset();
+  if (owner) free(base);
+}
+
+/***************************************************************************************
+** Function name:           DSW_arena::alloc
+** Description:             Take an aligned block from the top, nullptr if no room
+***************************************************************************************/
+void *DSW_arena::alloc(size_t size, size_t align)
+{
+  uintptr_t p = ((uintptr_t)top + align - 1) & ~(uintptr_t)(align - 1);
+  if (p + size > (uintptr_t)end) return nullptr;
+
+  top = (uint8_t *)(p + size);
+  return (void *)p;
+}
+
+/***************************************************************************************
+** Function name:           DSW_arena::addCleanup
+** Description:             List an object that needs a destructor call on release
+***************************************************************************************/
+bool DSW_arena::addCleanup(void (*destroy)(void *, uint16_t), uint16_t n)
+{
+  dsw_cleanup_t *c = (dsw_cleanup_t *)alloc(sizeof(dsw_cleanup_t), alignof(dsw_cleanup_t));
+  if (!c) return false;
+
+  c->destroy = destroy;
+  c->object  = nullptr; // Set when constructed
+  c->count   = n;
+  c->next    = cleanup;
+  cleanup    = c;
+  return true;
+}
+
+/***************************************************************************************
+** Function name:           DSW_arena::release
+** Description:             Destroy the objects above mark and move the top back to it
+***************************************************************************************/
+void DSW_arena::release(uint8_t *mark)
+{
+  // Cleanup records are in the arena so the ones above mark are for newer objects
+  while (cleanup && (uint8_t *)cleanup >= mark)
+  {
+    if (cleanup->object) cleanup->destroy(cleanup->object, cleanup->count);
+    cleanup = cleanup->next;
+  }
+
+  top = mark;
+}
+
+/***************************************************************************************
+** Function name:           DSW_arena::minutely, hourly and daily
+** Description:             Create a section structure and its selected arrays
+***************************************************************************************/
+#define DSW_ARENA_ALLOC(S, s, m, k, kind)                                               \
+  if (fields & DSW_##S##_##m) {                                                         \
+    p->m = array<DSW_TYPE_##kind>(n, DSW_INIT_##kind);                                  \
+    if (!p->m) { release(mark); return nullptr; }                                       \
+  }
+
+#define DSW_ARENA_SECTION(S, s, name)                                                   \
+name *DSW_arena::s(uint16_t n, uint32_t fields)                                         \
+{                                                                                       \
+  uint8_t *mark = top;                                                                  \
+  name *p = create<name>();                                                             \
+  if (!p) return nullptr;                                                               \
+  p->fields = fields;                                                                   \
+  p->size = n;                                                                          \
+  DSW_##S##_ARRAYS(DSW_ARENA_ALLOC, S, s)                                               \
+  return p;                                                                             \
+}
+
+DSW_ARENA_SECTION(MINUTELY, minutely, DSW_minutely_a)
+DSW_ARENA_SECTION(HOURLY, hourly, DSW_hourly_a)
+DSW_ARENA_SECTION(DAILY, daily, DSW_daily_a)
+
+/***************************************************************************************
+** Function name:           sectionOf
+** Description:             Convert a section key to a dsw_section_t
+***************************************************************************************/
+uint8_t DS_Weather::sectionOf(dsw_key_t key)
+{
+  switch (key) {
+    case DSW_KEY_currently: return DSW_CURRENT;
+    case DSW_KEY_minutely:  return DSW_MINUTELY;
+    case DSW_KEY_hourly:    return DSW_HOURLY;
+    case DSW_KEY_daily:     return DSW_DAILY;
+    default:                return DSW_SECTIONS;
+  }
+}
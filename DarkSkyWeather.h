@@ -18,7 +18,160 @@
 
 #include "User_Setup.h"
 #include "Data_Point_Set.h"
+#include "DSW_View.h"
+#include "DSW_Arena.h"
+#include "DSW_Compact.h"
+#include "DSW_Query.h"
+#include "DSW_History.h"
+#include "DSW_Inflate.h"
+#include "DSW_Ring.h"
+#include "DSW_Parser.h"
 
+class JSON_Decoder;
+
+/***************************************************************************************
+** Description:   Key identifiers for the JSON names the library acts on
+***************************************************************************************/
+// The names are hashed at compile time so the value() decode is a switch statement
+// instead of a long chain of String compares. The compiler rejects duplicate case
+// values, so a hash collision between two listed names will not compile (the hash
+// is "perfect" for this set). An unknown key may still collide with a listed one,
+// so a match is confirmed with a single strcmp() against the name table.
+
+#define DSW_KEY_LIST(X) \
+  X(currently)          \
+  X(minutely)           \
+  X(hourly)             \
+  X(daily)              \
+  X(data)               \
+  X(timezone)           \
+  X(time)               \
+  X(summary)            \
+  X(icon)               \
+  X(precipIntensity)    \
+  X(precipType)         \
+  X(precipProbability)  \
+  X(precipAccumulation) \
+  X(temperature)        \
+  X(temperatureHigh)    \
+  X(temperatureLow)     \
+  X(humidity)           \
+  X(pressure)           \
+  X(windSpeed)          \
+  X(windGust)           \
+  X(windBearing)        \
+  X(cloudCover)         \
+  X(sunriseTime)        \
+  X(sunsetTime)         \
+  X(moonPhase)
+
+#define DSW_KEY_ENUM(name) DSW_KEY_##name,
+
+enum dsw_key_t : uint8_t {
+  DSW_KEY_NONE = 0,     // Unknown or unused key
+  DSW_KEY_LIST(DSW_KEY_ENUM)
+  DSW_KEY_COUNT
+};
+
+// 32 bit FNV-1a hash, evaluated by the compiler for constant strings
+constexpr uint32_t dsw_hash(const char *s, uint32_t h = 2166136261UL) {
+  return *s ? dsw_hash(s + 1, (h ^ (uint8_t)*s) * 16777619UL) : h;
+}
+
+// Sections for streamForecast(), OR together e.g. DSW_STREAM_HOURLY | DSW_STREAM_DAILY
+#define DSW_STREAM_MINUTELY (1 << DSW_MINUTELY)
+#define DSW_STREAM_HOURLY   (1 << DSW_HOURLY)
+#define DSW_STREAM_DAILY    (1 << DSW_DAILY)
+
+// Content-Encoding values for DSW_header
+#define DSW_ENCODING_IDENTITY 0
+#define DSW_ENCODING_GZIP     1
+#define DSW_ENCODING_OTHER    2
+#define DSW_ENCODING_DEFLATE  3
+
+#define DSW_LINE_SIZE 64 // Header line buffer, longer lines are truncated
+
+// Chunked transfer decoder states
+#define DSW_CHUNK_SIZE      0 // Hex chunk size
+#define DSW_CHUNK_EXTENSION 1 // Rest of the chunk size line, ignored
+#define DSW_CHUNK_DATA      2
+#define DSW_CHUNK_END       3 // CRLF after the chunk data
+#define DSW_CHUNK_TRAILER   4 // Trailer lines after the last (zero size) chunk
+#define DSW_CHUNK_DONE      5 // Body complete
+
+// Response header values, set by parseRequest() and available to the sketch
+typedef struct DSW_header {
+  uint16_t status;        // HTTP status code e.g. 200, 0 if no response was received
+  int32_t  contentLength; // Body length, -1 if not sent
+  bool     chunked;       // true if Transfer-Encoding is chunked
+  uint8_t  encoding;      // Content-Encoding, DSW_ENCODING_IDENTITY, _GZIP, _DEFLATE or _OTHER
+  int32_t  apiCalls;      // X-Forecast-API-Calls count of requests made today, -1 if not sent
+  bool     close;         // true if the server closes the connection after the response
+} DSW_header;
+
+// How the last request was connected, see DSW_KEEP_ALIVE in User_Setup.h
+#define DSW_CONNECT_NONE    0 // Connection failed
+#define DSW_CONNECT_FULL    1 // New socket, full TLS handshake
+#define DSW_CONNECT_RESUMED 2 // New socket, TLS session offered for resumption (ESP8266 BearSSL)
+#define DSW_CONNECT_REUSED  3 // Kept alive socket, no handshake
+
+// Times a request is sent again, once for a stale kept alive socket and once without
+// gzip if the inflate window was too small, see endRequest()
+#define DSW_RETRIES 2
+
+typedef struct DSW_connection {
+  uint8_t  type;        // DSW_CONNECT_FULL etc
+  uint32_t connectTime; // Milliseconds taken by connect() including the handshake, 0 if reused
+  uint16_t requests;    // Requests sent on the socket, including the last one
+} DSW_connection;
+
+// Secure client kept between requests, defined in DarkSkyWeather.cpp
+struct DSW_client;
+
+// poll() states of a request started by beginForecast()
+#define DSW_FETCH_IDLE    0 // No request started
+#define DSW_FETCH_CONNECT 1 // Connecting and sending the request
+#define DSW_FETCH_HEADER  2 // Reading the response header
+#define DSW_FETCH_BODY    3 // Reading and parsing the body
+#define DSW_FETCH_DONE    4 // Finished, parsed without errors
+#define DSW_FETCH_FAILED  5 // Finished, connection, response or parse error
+
+// Request state, defined in DarkSkyWeather.cpp
+struct DSW_fetch;
+
+#define DSW_NOT_FOUND 0xFFFF // DSW_aggregate index if no value qualified
+
+// Running statistics of one data point, updated as each value is parsed so they are
+// available even if the data point is not stored. The sketch sets the first four
+// members, e.g. the maximum temperature in the next 12 hours and the first minute the
+// rain intensity reaches 0.5:
+//
+//   DSW_aggregate stats[2] = { { DSW_FIELD_hourly_temperature, 0, 12 },
+//                              { DSW_FIELD_minutely_precipIntensity, 0, 0, 0.5 } };
+//   dsw.setAggregates(stats, 2);
+//
+// The results are cleared at the start of each forecast. Percentages are 0-100 as for
+// the structs, text, icon and precipType data points are not numeric so are ignored.
+typedef struct DSW_aggregate {
+  uint8_t  field;      // dsw_field_t e.g. DSW_FIELD_hourly_temperature
+  uint16_t first;      // First "data" array element included, 0 for a section value
+  uint16_t count;      // Elements included, 0 for all to the end of the array
+  float    threshold;  // Level for crossIndex
+
+  uint16_t n;          // Values included
+  float    min;
+  float    max;
+  float    sum;
+  uint16_t minIndex;   // Element of the first minimum
+  uint16_t maxIndex;   // Element of the first maximum
+  uint16_t crossIndex; // First element with value >= threshold, DSW_NOT_FOUND if none
+
+  float mean() const { return n ? sum / n : 0; }
+} DSW_aggregate;
+
+// Sketch function called by streamForecast() as each "data" array element ends,
+// section is DSW_MINUTELY, DSW_HOURLY or DSW_DAILY and index counts from 0
+typedef void (*dsw_point_callback_t)(uint8_t section, uint16_t index, const DSW_datapoint &point);
 
 /***************************************************************************************
 ** Description:   JSON interface class
@@ -26,89 +179,408 @@
 class DS_Weather: public JsonListener {
 
   public:
+    ~DS_Weather() { cancelForecast(); closeConnection(); }
+
     // Sketch calls this forecast request, it returns true if no parse errors encountered
     // Provided for backwards compatibility prior to adding minutely data request
-    bool getForecast(DSW_current *current, DSW_hourly *hourly, DSW_daily  *daily,
+    template <class C, class H, class D>
+    bool getForecast(C current, H hourly, D daily,
                      String api_key, String latitude, String longitude,
-                     String units, String language);
+                     String units, String language)
+    {
+      return getForecast(current, nullptr, hourly, daily, api_key, latitude, longitude, units, language);
+    }
 
     // Sketch calls this forecast request, it returns true if no parse errors encountered
     // This function requests minutely data in addtition to the others
-    bool getForecast(DSW_current *current, DSW_minutely *minutely, DSW_hourly *hourly, DSW_daily  *daily,
+    // The structs can be the DSW_current etc defaults or any DSW_current_t<> etc type,
+    // or for minutely, hourly and daily a lazy view e.g. DSW_hourly_view (DSW_View.h)
+    // or a runtime sized structure from a DSW_arena e.g. DSW_hourly_a (DSW_Arena.h)
+    // or a compact structure e.g. DSW_hourly_compact (DSW_Compact.h)
+    // Returns false if a beginForecast() request is in progress, its binding is kept
+    template <class C, class M, class H, class D>
+    bool getForecast(C current, M minutely, H hourly, D daily,
                      String api_key, String latitude, String longitude,
-                     String units, String language);
+                     String units, String language)
+    {
+      if (fetch) return false;
+
+      memset(&binding, 0, sizeof(binding));
+      binding.textPool = summaryPool;
+      bindFields(current);
+      bindFields(minutely);
+      bindFields(hourly);
+      bindFields(daily);
+      bindWatched();
+
+      return requestForecast(api_key, latitude, longitude, units, language);
+    }
+
+    // Sketch calls this forecast request, it returns true if no parse errors encountered
+    // The minutely, hourly and daily data points selected by "sections" are passed to the
+    // callback one at a time, so only one DSW_datapoint record is held in memory. The
+    // current weather is stored in "current" as for getForecast(), nullptr to exclude.
+    // Returns false if a beginForecast() request is in progress.
+    template <class C>
+    bool streamForecast(C current, uint8_t sections, dsw_point_callback_t callback,
+                        String api_key, String latitude, String longitude,
+                        String units, String language)
+    {
+      if (fetch) return false;
+
+      DSW_datapoint point;
+
+      memset(&binding, 0, sizeof(binding));
+      bindFields(current);
+
+      if (!callback) sections = 0;
+      for (uint8_t section = DSW_MINUTELY; section <= DSW_DAILY; section++) {
+        if (sections & (1 << section)) point.dswBind(binding, section);
+      }
+      bindWatched();
+
+      streamSections = sections;
+      pointCallback  = callback;
+      streamPoint    = &point;
+
+      bool result = requestForecast(api_key, latitude, longitude, units, language);
+
+      streamSections = 0;
+      pointCallback  = nullptr;
+      streamPoint    = nullptr;
+
+      return result;
+    }
+
+    // Non-blocking forecast request, the structs are bound as for getForecast(). The
+    // request is made by calling poll() (e.g. once per loop()) until it returns
+    // DSW_FETCH_DONE or DSW_FETCH_FAILED, the structs must not be read or deleted before
+    // then. Returns false if a request is already in progress.
+    template <class C, class M, class H, class D>
+    bool beginForecast(C current, M minutely, H hourly, D daily,
+                       String api_key, String latitude, String longitude,
+                       String units, String language)
+    {
+      if (fetch) return false;
+
+      memset(&binding, 0, sizeof(binding));
+      binding.textPool = summaryPool;
+      bindFields(current);
+      bindFields(minutely);
+      bindFields(hourly);
+      bindFields(daily);
+      bindWatched();
+
+      return beginRequest(api_key, latitude, longitude, units, language);
+    }
+
+    // Do the next step of the request: connect and send it, or read and parse one block
+    // of up to DSW_BUFFER_SIZE bytes. Returns the state, DSW_FETCH_BODY etc. The state
+    // stays DSW_FETCH_DONE or DSW_FETCH_FAILED until the next beginForecast()
+    uint8_t poll();
+
+    // Stop a request started by beginForecast(), poll() then returns DSW_FETCH_FAILED
+    void cancelForecast();
+
+    // Response bytes received so far, with header.contentLength this shows the progress
+    uint32_t bytesReceived() { return received; }
 
     // Called by library (or user sketch), sends a GET request to a https (secure) url
     bool parseRequest(String url); // and parses response, returns true if no parse errors
+                                   // (false if a beginForecast() request is in progress)
+
+    // Parse a JSON forecast message already in memory instead of fetching it, e.g. for
+    // tests or benchmarks. Returns true if no parse errors encountered. useJsonDecoder
+    // selects the JSON_Decoder library (JsonListener virtual callbacks) for comparison.
+    // Returns false if a beginForecast() request is in progress
+    template <class C, class M, class H, class D>
+    bool parseForecast(C current, M minutely, H hourly, D daily,
+                       const uint8_t *json, size_t length, bool useJsonDecoder = false)
+    {
+      if (fetch) return false;
+
+      memset(&binding, 0, sizeof(binding));
+      binding.textPool = summaryPool;
+      bindFields(current);
+      bindFields(minutely);
+      bindFields(hourly);
+      bindFields(daily);
+      bindWatched();
+
+      bool result = parseMessage(json, length, useJsonDecoder);
+      if (result) addSnapshot();
+
+      memset(&binding, 0, sizeof(binding));
+
+      return result;
+    }
 
     // Convert the icon index to a name e.g. "partly-cloudy"
-    const char* iconName(uint8_t index);
+    static const char* iconName(uint8_t index);
+
+    // Pool holding the summaries of compact structs e.g. DSW_hourly_compact, see
+    // DSW_Compact.h. It is emptied at the start of each forecast, nullptr for none
+    void setSummaryPool(DSW_text_pool *pool) { summaryPool = pool; }
+
+    // Running statistics to calculate during each forecast, see DSW_aggregate. The
+    // array is kept by the sketch, nullptr (or count 0) for none
+    void setAggregates(DSW_aggregate *list, uint8_t count) { aggregates = list; aggregateCount = count; }
+
+    // History a snapshot of the current weather is added to after each successful
+    // forecast, see DSW_History.h. hourly adds the first hourly data point to it
+    void setHistory(DSW_history *history, bool hourly = false) { this->history = history; historyHourly = hourly; }
+
+    // Decoder for compressed responses, see DSW_Inflate.h. When set the request asks
+    // the server for gzip, nullptr to ask for an uncompressed response
+    void setInflater(DSW_inflate *inflater) { this->inflater = inflater; inflateOff = false; }
+
+#ifdef DSW_PIPELINE
+    // Ring to pass the response body to a parse task on the other core, see DSW_Ring.h.
+    // nullptr to read and parse on the calling task
+    void setPipeline(DSW_ring *ring) { this->ring = ring; }
+#endif
+
+    // Data points whose values changed in the last forecast, compared with the values
+    // the structs held before it, e.g. if (dsw.changes(DSW_DAILY) & DSW_DAILY_icon).
+    // Reuse the structs (see reset()) for this to be useful, a new struct holds defaults.
+    // Lazy views, streamed sections and compact struct summaries are always changed.
+    uint32_t changes(uint8_t section);
+
+    // false if nothing changed in the last forecast, so there is nothing to redraw
+    bool changed() { return changedFields != 0; }
+
+    // Values from the last response header, e.g. header.apiCalls
+    DSW_header header;
+
+    // How the last request was connected, e.g. connection.connectTime
+    DSW_connection connection;
+
+    // Close the connection kept open by DSW_KEEP_ALIVE (if any) and free the client,
+    // e.g. before WiFi is turned off. The next request will connect again
+    void closeConnection();
+
+  private: // Request and response handling
+
+    // Store the struct field pointers so value() can populate them
+    template <class T> void bindFields(T *data) { if (data) data->dswBind(binding); }
+    void bindFields(decltype(nullptr)) { }
+
+    // Add the aggregate and history data points to the binding so they are parsed even
+    // if not stored, end is the number of "data" elements needed
+    void bindWatched();
+    void watchField(uint8_t field, uint32_t end);
+
+    // Build the url for the bound data sets and call parseRequest()
+    bool requestForecast(String api_key, String latitude, String longitude,
+                         String units, String language);
+    String forecastUrl(String api_key, String latitude, String longitude,
+                       String units, String language);
+
+    // Start the request for beginForecast() and finish it for poll()
+    bool beginRequest(String api_key, String latitude, String longitude,
+                      String units, String language);
+    void endFetch(bool result);
+
+    DSW_fetch *fetch = nullptr;          // Request in progress
+    uint8_t    fetchState = DSW_FETCH_IDLE;
+
+    // Connect (or reuse the kept alive socket), send the GET request and read the response
+    template <class P> bool sendRequest(DSW_client &link, P &parser, const String &url);
+    bool startRequest(DSW_client &link, const String &url);
+    bool endRequest(DSW_client &link, bool result); // Returns true to retry on a new socket
+    bool openConnection(DSW_client &link, const char *host);
+    void setupClient(DSW_client &link);             // Certificate checks
+
+    DSW_client *client = nullptr; // Kept between requests if DSW_KEEP_ALIVE is defined
+
+    // Check the response header and feed the body to the parser, T is the client class
+    template <class T, class P> bool readResponse(T &client, P &parser);
+    template <class T, class P> int8_t readBlock(T &client, P &parser); // 0 until the end
+    int8_t endResponse();
+
+#ifdef DSW_PIPELINE
+    // Read the body into the ring while a parse task drains it, 0 if the response is
+    // to be read by readBlock() instead
+    template <class T, class P> int8_t pipeResponse(T &client, P &parser);
+    template <class T> int8_t pipeBlock(T &client); // 0 until the end
+    template <class P> static void parseEntry(void *weather); // Parse task function
+    template <class P> void parseRing(P &parser);
+
+    DSW_ring *ring = nullptr; // Set by setPipeline()
+    void     *pipeParser;     // Parser used by the parse task
+    bool      pipeFault;      // Inflate error in the parse task
+#endif
+
+    uint32_t responseStart; // millis() when the request was sent
+    uint32_t received = 0;  // Response bytes read
+    bool     draining;      // Reading the rest of the body to keep the connection
+    bool     compressed;    // Body is being inflated
+    bool     gzipRequested; // Accept-Encoding sent, see endRequest()
+
+    // Zero allocation response header scanner, fills in "header"
+    void headerStart();
+    int  scanHeader(const uint8_t *buffer, int count); // Returns bytes used by the header
+    void headerLine();
+
+    bool    headerDone;                // true when the blank line ending the header is found
+    char    lineBuffer[DSW_LINE_SIZE]; // Header line being collected
+    uint8_t lineLength;
+
+    // Chunked transfer decoder, removes the chunk framing from a block in place
+    int  dechunk(uint8_t *buffer, int count); // Returns the body bytes left in buffer
+    bool bodyEnd();                           // true when the whole body has been read
+
+    int32_t  bodyRemaining;  // Content-Length bytes left to read, -1 if not known
+    uint8_t  chunkState;     // DSW_CHUNK_SIZE etc
+    uint32_t chunkRemaining; // Bytes left in the current chunk
+
+    // Parse a complete message held in memory, used by parseForecast()
+    bool parseMessage(const uint8_t *json, size_t length, bool useJsonDecoder);
+
+    // Decompress a block of the body and feed the output to the parser, false on error
+    template <class P> bool inflateBlock(P &parser, const uint8_t *buffer, int count);
+
+    // Feed a block of bytes read from the client to the parser
+    void parseBlock(DSW_Parser<DS_Weather> &parser, const uint8_t *buffer, int count);
+    void parseBlock(JSON_Decoder &parser, const uint8_t *buffer, int count);
+    void showJSON(const uint8_t *buffer, int count); // Debug output if SHOW_JSON defined
+
+    uint8_t rxBuffer[DSW_BUFFER_SIZE]; // Reused for every block read from the client
 
   private: // Streaming parser callback functions, allow tracking and decisions
 
+    // DSW_Parser calls these directly (not via the JsonListener virtual functions) so
+    // the compiler can inline them, whitespace() is not called at all
+    template <class L> friend class DSW_Parser;
+    friend class DSW_view; // Uses the value decoders
+    static const bool parseWhitespace = false;
+
     void startDocument(); // JSON document has started, typically starts once
-                          // Initialises varaibles used, e.g. sets objectLayer = 0
-                          // and arrayIndex =0
+                          // Initialises varaibles used, e.g. sets depth = 0
+                          // and dataIndex = 0
     void endDocument();   // JSON document has ended, typically ends once
 
     void startObject();   // Called every time an Object start detected
                           // may be called multiple times as object layers entered
-                          // Used to increment objectLayer
+                          // Pushes a level on the parse context stack
     void endObject();     // Called every time an object ends
-                          // Used to decrement objectLayer and zero arrayIndex
+                          // Pops a level, increments dataIndex if a data point ended
 
 
-    void startArray();    // An array of name:value pairs entered
-    void endArray();      // Array member ended, increments arrayIndex
+    void startArray();    // An array of name:value pairs entered, zeroes dataIndex
+    void endArray();      // Array ended, pops a level
 
     void key(const char *key);            // The current "object" or "name for a name:value pair"
     void value(const char *value);        // String value from name:value pair e.g. "1.23" or "rain"
+                                          // numbers are decoded in place, only text is copied
 
     void whitespace(char c);              // Whitespace character in JSON - not used
 
+    bool skipValue();                     // true if DSW_Parser can skip the value of the
+                                          // last key, i.e. it is not a bound data point
+
     void error( const char *message );    // Error message is sent to serial port
 
 
-    uint8_t iconIndex(const char *val);   // Convert the icon name e.g. "partly-cloudy" to an array
-                                          // index to save memory, range 0 to MAX_ICON_INDEX
+    // Convert the icon name e.g. "partly-cloudy" to an array index to save memory,
+    // range 0 to MAX_ICON_INDEX
+    static uint8_t iconIndex(const char *val);
 
-  private: // Variables used internal to library
+    dsw_key_t keyId(const char *key);     // Convert a JSON name to a dsw_key_t, DSW_KEY_NONE if unused
+
+    // Numeric value decoding straight from the parser's character buffer
+    static void     scanDecimal(const char *val, uint32_t *m, int16_t *e, bool *neg);
+    static int32_t  fixedPoint(const char *val, uint8_t decimals); // e.g. ("0.58", 2) = 58
+    static uint32_t toUnsigned(const char *val);                   // e.g. unix time
+    static uint8_t  toPercent(const char *val);                    // e.g. "0.58" = 58
+    static float    decimalToFloat(const char *val);
+
+    // Update the aggregates of currentField with a value from "data" element i
+    void aggregate(uint16_t i, const char *val);
+
+    // Store a value in the history snapshot, added to the history by addSnapshot()
+    void snapshotValue(const char *val);
+    void addSnapshot();
+    static uint8_t fieldSection(uint8_t field); // dsw_section_t of a dsw_field_t
+
+    // Store a value if it differs from the one held, marking currentField as changed
+    template <class T> void update(T *p, T val) {
+      if (*p == val) return;
+      *p = val;
+      changedFields |= 1ULL << currentField;
+    }
+    void update(String *p, const char *val);
+
+    // Compact struct storage, see DSW_Compact.h
+    void compactValue(uint8_t section, void *slot, uint16_t i, const char *val);
+    static int32_t  roundedFixed(const char *val, uint8_t decimals, int32_t min, int32_t max);
+    static uint32_t clampedOffset(uint32_t t, uint32_t base, uint32_t step, uint32_t max);
+
+    void enterLevel(bool array);          // Push and pop the parse context stack
+    void exitLevel();
 
-    uint16_t minutely_index; // index into the DSW_hourly structure's data arrays
-    uint16_t hourly_index;   // index into the DSW_hourly structure's data arrays
-    uint16_t daily_index;    // index into the DSW_daily structure's data arrays
+    bool inDataPoint();                   // true if inside an element of a section "data" array
+
+    void sectionDone(uint8_t section);    // Section complete, no more values needed from it
+
+    uint8_t fieldId(dsw_key_t key);       // Data point for a key in the current context
+    uint8_t sectionOf(dsw_key_t key);     // dsw_section_t for a section key, DSW_SECTIONS if none
+
+  private: // Variables used internal to library
 
     // The value storage structures are created and deleted by the sketch and
-    // a pointer passed via the library getForecast() call the value() function
-    // is then used to populate the structs with values
-    DSW_current  *current;  // pointer provided by sketch to the DSW_current struct
-	DSW_minutely *minutely; // pointer provided by sketch to the DSW_minutely struct
-    DSW_hourly   *hourly;   // pointer provided by sketch to the DSW_hourly struct
-    DSW_daily    *daily;    // pointer provided by sketch to the DSW_daily struct
+    // pointers passed via the library getForecast() call. The binding holds a
+    // pointer to each data point member, the value() function then uses it to
+    // populate the structs with values
+    dsw_binding_t binding;
+
+    DSW_text_pool *summaryPool = nullptr; // Set by setSummaryPool()
+
+    DSW_aggregate *aggregates = nullptr;   // Set by setAggregates()
+    uint8_t        aggregateCount = 0;
+    uint64_t       aggregateFields = 0;    // Bit n set if dsw_field_t n has an aggregate
 
-    String      valuePath;  // object (i.e. sequential key) path (like a "file path")
-                            // taken to the name:value pair in the form "hourly/data"
-                            // so values can be pulled from the correct array.
-                            // Needed since different objects contain "data" arrays.
+    DSW_inflate   *inflater = nullptr;     // Set by setInflater()
+    bool           inflateOff = false;     // true if the window was too small, gzip not requested
 
-    String data_set;        // A copy of the last object name at the head of an array
-                            // short equivalent to path.
+    DSW_history   *history = nullptr;      // Set by setHistory()
+    bool           historyHourly = false;
+    uint64_t       historyFields = 0;      // Bit n set if dsw_field_t n is in the snapshot
+    DSW_snapshot   snapshot;               // Filled during the parse
+
+    uint64_t       unstoredFields = 0;     // Bit n set if field n is only aggregated or in the history
+
+    uint64_t       changedFields = 0;      // Bit n set if dsw_field_t n changed, see changes()
+    uint8_t        timeBaseSet;            // Bit n set when the compact time base of section n is set
+    uint8_t        timeBaseMoved;          // Bit n set if it differs from the last forecast
+    uint16_t       watchedEnd[DSW_SECTIONS] = { 0 }; // "data" elements the above need
+
+    // Set by streamForecast() for the sections passed to the sketch one data point at
+    // a time, point is filled by value() and passed to the callback by endObject()
+    uint8_t              streamSections = 0;
+    dsw_point_callback_t pointCallback  = nullptr;
+    DSW_datapoint       *streamPoint    = nullptr;
 
     bool     parseOK;       // true if the parse been completed
                             // (does not mean data values gathered are good!)
 
-    String   currentParent; // Current object e.g. "daily"
-    uint16_t objectLevel;   // Object level, increments for new object, decrements at end
-    String   currentKey;    // Name key of the name:value pair e.g "temperature"
-    String   arrayPath;     // Path to name:value pair e.g.  "daily/data"
-    uint16_t arrayIndex;    // Array index e.g. 5 for day 5 forecast, qualify with arrayPath
+    uint8_t  pendingSections; // Bit n set while section n has bound data points to come
+    bool     dataComplete;    // true when all bound sections are complete, the rest of
+                              // the response is not needed so parseRequest() stops
 
-    // Lookup table to convert  an array index to a weather icon bmp filename e.g. rain.bmp
+    // Parse context, held as a fixed depth stack of key identifiers so tracking the
+    // position in the JSON message needs no heap Strings. For a daily forecast value
+    // the stack is: root object, "daily" object, "data" array, unnamed element object.
+    dsw_key_t contextKey[DSW_MAX_DEPTH]; // Key naming each open object or array
+    uint8_t   arrayLevels;  // Bit n set if level n is an array (not an object)
+    uint8_t   depth;        // Count of open objects and arrays
+    dsw_key_t currentKeyId; // Key of the name:value pair e.g DSW_KEY_temperature
+    uint8_t   currentField; // dsw_field_t for the key in this context, DSW_FIELD_NONE if unused
+    uint16_t  dataIndex;    // Index of current "data" array element e.g. 5 for day 5
 
-// A partly-cloudy-night means a clear day as noted in issue #7
-    const char* iconList[MAX_ICON_INDEX + 1] = {"unknown", "rain", "sleet", "snow", "clear-day",
-    "clear-night", "partly-cloudy-day", "partly-cloudy-night", "cloudy", "fog",
-    "wind", "none" };
+    // Lookup table to convert  an array index to a weather icon bmp filename e.g. rain.bmp
+    // One table is shared by all instances, it is in DarkSkyWeather.cpp
+    static const char* const iconList[MAX_ICON_INDEX + 1];
 
 };
 
@@ -9,176 +9,491 @@
 // the example requests the forecast every 15 minutes, so adapting to reduce memory
 // by requesting current, daily, hourly etc forescasts individually can be done.
 
-// The content is zero or "" when first created.
+// The content is zero or "" when first created. A struct can be reused for each forecast,
+// reset() sets the values back to the defaults without releasing the String buffers.
 
-#ifndef MINIMISE_DATA_POINTS // Full set of values populated if not defined
-/***************************************************************************************
-** Description:   Structure for current weather
-***************************************************************************************/
-typedef struct DSW_current {
-
-  String   timezone;
-  uint32_t time = 0;
-  String   summary;
-  uint8_t  icon = 0;
-  float    precipIntensity = 0;
-  uint8_t  precipType = NO_VALUE;
-  uint8_t  precipProbability = 0;
-  float    temperature = 0;
-  uint8_t  humidity = 0;
-  float    pressure = 0;
-  float    windSpeed = 0;
-  float    windGust = 0;
-  uint16_t windBearing = 0;
-  uint8_t  cloudCover = 0;
-} DSW_current;
+// Each structure is a template, the sketch picks the data points it needs with a bit mask
+// and the compiler generates a struct containing only those members, for example:
+//
+//   typedef DSW_current_t<DSW_CURRENT_time | DSW_CURRENT_temperature> My_current;
+//   typedef DSW_daily_t<DSW_DAILY_time | DSW_DAILY_icon, 5> My_daily; // 5 days
+//
+// Data points not selected use no RAM and the library does not decode them. A section
+// with no data points selected is excluded from the server request. The DSW_current,
+// DSW_minutely, DSW_hourly and DSW_daily types at the end of this file are the default
+// sets, all data points unless MINIMISE_DATA_POINTS is defined in User_Setup.h
+
+#ifndef Data_Point_Set_h
+#define Data_Point_Set_h
+
+#ifdef MINIMISE_DATA_POINTS
+  #undef  MAX_DAYS
+  #define MAX_DAYS 5 // Today + 7 days = 8 maximum, make it 5 for TFT_eSPI example
+#endif
 
 /***************************************************************************************
-** Description:   Structure for minutely weather
+** Description:   Data point lists, one entry per value that can be stored
 ***************************************************************************************/
-typedef struct DSW_minutely {
+// X(SECTION, section, member name, JSON key, kind of value)
+// The "SCALARS" are single values, the "ARRAYS" hold one value per "data" array element.
+// The current timezone is the name:value pair in the root object, not in "currently"
+
+#define DSW_CURRENT_SCALARS(X, S, s)                \
+  X(S, s, time,               time,               UNIX)  \
+  X(S, s, summary,            summary,            TEXT)  \
+  X(S, s, icon,               icon,               ICON)  \
+  X(S, s, precipIntensity,    precipIntensity,    RATE)  \
+  X(S, s, precipType,         precipType,         PTYPE) \
+  X(S, s, precipProbability,  precipProbability,  PCT)   \
+  X(S, s, temperature,        temperature,        TEMP)  \
+  X(S, s, humidity,           humidity,           PCT)   \
+  X(S, s, pressure,           pressure,           PRESS) \
+  X(S, s, windSpeed,          windSpeed,          SPEED) \
+  X(S, s, windGust,           windGust,           SPEED) \
+  X(S, s, windBearing,        windBearing,        U16)   \
+  X(S, s, cloudCover,         cloudCover,         PCT)   \
+  X(S, s, timezone,           timezone,           TEXT)
 
-  String   overallSummary;
-  uint8_t  icon = 0;
-  uint32_t time[MAX_MINUTES] = { 0 }; // maybe store as a minute start time + minute
-                                      // count uint8_t as 0-59
-  float    precipIntensity[MAX_MINUTES] = { 0 };
-  uint8_t  precipProbability[MAX_MINUTES] = { 0 };
+#define DSW_MINUTELY_SCALARS(X, S, s)               \
+  X(S, s, overallSummary,     summary,            TEXT)  \
+  X(S, s, icon,               icon,               ICON)
 
-} DSW_minutely;
+#define DSW_MINUTELY_ARRAYS(X, S, s)                \
+  X(S, s, time,               time,               UNIX)  \
+  X(S, s, precipIntensity,    precipIntensity,    RATE)  \
+  X(S, s, precipProbability,  precipProbability,  PCT)
+
+#define DSW_HOURLY_SCALARS(X, S, s)                 \
+  X(S, s, overallSummary,     summary,            TEXT)
+
+#define DSW_HOURLY_ARRAYS(X, S, s)                  \
+  X(S, s, summary,            summary,            TEXT)  \
+  X(S, s, time,               time,               UNIX)  \
+  X(S, s, precipIntensity,    precipIntensity,    RATE)  \
+  X(S, s, precipType,         precipType,         PTYPE) \
+  X(S, s, precipProbability,  precipProbability,  PCT)   \
+  X(S, s, precipAccumulation, precipAccumulation, ACCUM) \
+  X(S, s, temperature,        temperature,        TEMP)  \
+  X(S, s, pressure,           pressure,           PRESS) \
+  X(S, s, cloudCover,         cloudCover,         PCT)
+
+#define DSW_DAILY_SCALARS(X, S, s)                  \
+  X(S, s, overallSummary,     summary,            TEXT)
+
+#define DSW_DAILY_ARRAYS(X, S, s)                   \
+  X(S, s, summary,            summary,            TEXT)  \
+  X(S, s, time,               time,               UNIX)  \
+  X(S, s, icon,               icon,               ICON)  \
+  X(S, s, sunriseTime,        sunriseTime,        UNIX)  \
+  X(S, s, sunsetTime,         sunsetTime,         UNIX)  \
+  X(S, s, moonPhase,          moonPhase,          PCT)   \
+  X(S, s, precipIntensity,    precipIntensity,    RATE)  \
+  X(S, s, precipProbability,  precipProbability,  PCT)   \
+  X(S, s, precipType,         precipType,         PTYPE) \
+  X(S, s, precipAccumulation, precipAccumulation, ACCUM) \
+  X(S, s, temperatureHigh,    temperatureHigh,    TEMP)  \
+  X(S, s, temperatureLow,     temperatureLow,     TEMP)  \
+  X(S, s, humidity,           humidity,           PCT)   \
+  X(S, s, pressure,           pressure,           PRESS) \
+  X(S, s, windSpeed,          windSpeed,          SPEED) \
+  X(S, s, windGust,           windGust,           SPEED) \
+  X(S, s, windBearing,        windBearing,        U16)   \
+  X(S, s, cloudCover,         cloudCover,         PCT)
 
 /***************************************************************************************
-** Description:   Structure for hourly weather
+** Description:   Identifiers and bit masks generated from the lists
 ***************************************************************************************/
-typedef struct DSW_hourly {
+enum dsw_section_t : uint8_t { DSW_CURRENT, DSW_MINUTELY, DSW_HOURLY, DSW_DAILY, DSW_SECTIONS };
+
+// The kind sets the storage type and how the JSON value is decoded
+enum dsw_kind_t : uint8_t {
+  DSW_KIND_TEXT,  // String
+  DSW_KIND_UNIX,  // uint32_t unix time
+  DSW_KIND_U16,   // uint16_t e.g. wind bearing
+  DSW_KIND_PCT,   // uint8_t percentage, JSON value range 0 to 1
+  DSW_KIND_ICON,  // uint8_t icon index
+  DSW_KIND_PTYPE, // uint8_t precipitation type icon index, NO_VALUE if none
+  DSW_KIND_FLOAT, // float
+  DSW_KIND_TEMP,  // float temperature, int16_t hundredths in the compact structs
+  DSW_KIND_PRESS, // float pressure, uint16_t tenths in the compact structs
+  DSW_KIND_RATE,  // float precipitation intensity, uint16_t thousandths when compact
+  DSW_KIND_ACCUM, // float precipitation accumulation, uint16_t hundredths when compact
+  DSW_KIND_SPEED  // float wind speed, uint16_t hundredths in the compact structs
+};
+
+// Bit number of each data point within its section, e.g. DSW_DAILY_BIT_icon
+#define DSW_BIT_ENUM(S, s, m, k, kind) DSW_##S##_BIT_##m,
+enum { DSW_CURRENT_SCALARS(DSW_BIT_ENUM, CURRENT, current) DSW_CURRENT_COUNT };
+enum { DSW_MINUTELY_SCALARS(DSW_BIT_ENUM, MINUTELY, minutely) DSW_MINUTELY_ARRAYS(DSW_BIT_ENUM, MINUTELY, minutely) DSW_MINUTELY_COUNT };
+enum { DSW_HOURLY_SCALARS(DSW_BIT_ENUM, HOURLY, hourly) DSW_HOURLY_ARRAYS(DSW_BIT_ENUM, HOURLY, hourly) DSW_HOURLY_COUNT };
+enum { DSW_DAILY_SCALARS(DSW_BIT_ENUM, DAILY, daily) DSW_DAILY_ARRAYS(DSW_BIT_ENUM, DAILY, daily) DSW_DAILY_COUNT };
 
-  String   overallSummary;
+// Bit masks used by a sketch to select data points, e.g. DSW_DAILY_icon
+#define DSW_MASK_ENUM(S, s, m, k, kind) DSW_##S##_##m = 1UL << DSW_##S##_BIT_##m,
+enum : uint32_t { DSW_CURRENT_SCALARS(DSW_MASK_ENUM, CURRENT, current) };
+enum : uint32_t { DSW_MINUTELY_SCALARS(DSW_MASK_ENUM, MINUTELY, minutely) DSW_MINUTELY_ARRAYS(DSW_MASK_ENUM, MINUTELY, minutely) };
+enum : uint32_t { DSW_HOURLY_SCALARS(DSW_MASK_ENUM, HOURLY, hourly) DSW_HOURLY_ARRAYS(DSW_MASK_ENUM, HOURLY, hourly) };
+enum : uint32_t { DSW_DAILY_SCALARS(DSW_MASK_ENUM, DAILY, daily) DSW_DAILY_ARRAYS(DSW_MASK_ENUM, DAILY, daily) };
 
-  String   summary[MAX_HOURS];
-  uint32_t time[MAX_HOURS] = { 0 };
-  float    precipIntensity[MAX_HOURS] = { 0 };
-  uint8_t  precipType[MAX_HOURS] = { NO_VALUE };
-  uint8_t  precipProbability[MAX_HOURS] = { 0 };
-  float    precipAccumulation[MAX_HOURS] = { 0 };
-  float    temperature[MAX_HOURS] = { 0 };
-  float    pressure[MAX_HOURS] = { 0 };
-  uint8_t  cloudCover[MAX_HOURS] = { 0 };
+#define DSW_CURRENT_ALL  ((1UL << DSW_CURRENT_COUNT)  - 1)
+#define DSW_MINUTELY_ALL ((1UL << DSW_MINUTELY_COUNT) - 1)
+#define DSW_HOURLY_ALL   ((1UL << DSW_HOURLY_COUNT)   - 1)
+#define DSW_DAILY_ALL    ((1UL << DSW_DAILY_COUNT)    - 1)
 
-} DSW_hourly;
+// Minimal set of data points for TFT_eSPI examples to reduce RAM needs
+#define DSW_CURRENT_TFT  (DSW_CURRENT_time | DSW_CURRENT_summary | DSW_CURRENT_icon |       \
+                          DSW_CURRENT_temperature | DSW_CURRENT_humidity |                   \
+                          DSW_CURRENT_pressure | DSW_CURRENT_windSpeed |                     \
+                          DSW_CURRENT_windBearing | DSW_CURRENT_cloudCover)
+#define DSW_MINUTELY_TFT 0
+#define DSW_HOURLY_TFT   0
+#define DSW_DAILY_TFT    (DSW_DAILY_overallSummary | DSW_DAILY_summary | DSW_DAILY_time |    \
+                          DSW_DAILY_icon | DSW_DAILY_sunriseTime | DSW_DAILY_sunsetTime |    \
+                          DSW_DAILY_moonPhase | DSW_DAILY_temperatureHigh |                  \
+                          DSW_DAILY_temperatureLow)
+
+// Library wide field number, sections in order, e.g. DSW_FIELD_hourly_temperature
+#define DSW_FIELD_ENUM(S, s, m, k, kind) DSW_FIELD_##s##_##m,
+enum dsw_field_t : uint8_t {
+  DSW_CURRENT_SCALARS(DSW_FIELD_ENUM, CURRENT, current)
+  DSW_MINUTELY_SCALARS(DSW_FIELD_ENUM, MINUTELY, minutely)
+  DSW_MINUTELY_ARRAYS(DSW_FIELD_ENUM, MINUTELY, minutely)
+  DSW_HOURLY_SCALARS(DSW_FIELD_ENUM, HOURLY, hourly)
+  DSW_HOURLY_ARRAYS(DSW_FIELD_ENUM, HOURLY, hourly)
+  DSW_DAILY_SCALARS(DSW_FIELD_ENUM, DAILY, daily)
+  DSW_DAILY_ARRAYS(DSW_FIELD_ENUM, DAILY, daily)
+  DSW_FIELD_COUNT,
+  DSW_FIELD_NONE = 0xFF
+};
+
+// First field number of each section, field = base + bit number
+#define DSW_CURRENT_BASE  0
+#define DSW_MINUTELY_BASE (DSW_CURRENT_BASE  + DSW_CURRENT_COUNT)
+#define DSW_HOURLY_BASE   (DSW_MINUTELY_BASE + DSW_MINUTELY_COUNT)
+#define DSW_DAILY_BASE    (DSW_HOURLY_BASE   + DSW_HOURLY_COUNT)
 
 /***************************************************************************************
-** Description:   Structure for daily weather
+** Description:   Where the parser stores each field
 ***************************************************************************************/
-typedef struct DSW_daily {
-
-  String   overallSummary;
-
-  String   summary[MAX_DAYS];
-  uint32_t time[MAX_DAYS] = { 0 };
-  uint8_t  icon[MAX_DAYS] = { 0 };
-  uint32_t sunriseTime[MAX_DAYS] = { 0 };
-  uint32_t sunsetTime[MAX_DAYS] = { 0 };
-  uint8_t  moonPhase[MAX_DAYS] = { 0 };
-  float    precipIntensity[MAX_DAYS] = { 0 };
-  uint8_t  precipProbability[MAX_DAYS] = { 0 };
-  uint8_t  precipType[MAX_DAYS] = { NO_VALUE };
-  float    precipAccumulation[MAX_DAYS] = { 0 };
-  float    temperatureHigh[MAX_DAYS] = { 0 };
-  float    temperatureLow[MAX_DAYS] = { 0 };
-  uint8_t  humidity[MAX_DAYS] = { 0 };
-  float    pressure[MAX_DAYS] = { 0 };
-  float    windSpeed[MAX_DAYS] = { 0 };
-  float    windGust[MAX_DAYS] = { 0 };
-  uint16_t windBearing[MAX_DAYS] = { 0 };
-  uint8_t  cloudCover[MAX_DAYS] = { 0 };
-
-} DSW_daily;
+// Filled in by the structures below when passed to getForecast()
+class DSW_view;
+class DSW_text_pool;
 
+typedef struct dsw_binding_t {
+  void     *slot[DSW_FIELD_COUNT];  // Storage for each field, nullptr if not stored
+  uint16_t  size[DSW_SECTIONS];     // "data" array elements each section can store
+  uint32_t  fields[DSW_SECTIONS];   // Data points stored for each section (bit mask)
+  DSW_view *view[DSW_SECTIONS];     // Lazy view storing the section, see DSW_View.h
+  uint32_t *timeBase[DSW_SECTIONS]; // Compact struct time base, see DSW_Compact.h
+  DSW_text_pool *textPool;          // Compact struct summaries, see DSW_Compact.h
+  uint16_t *records[DSW_SECTIONS];  // Struct count of "data" elements holding values
+} dsw_binding_t;
 
-#else // Collect minimal set of data points for TFT_eSPI examples to reduce RAM needs
+/***************************************************************************************
+** Description:   One struct template per data point, empty if not selected
+***************************************************************************************/
+// Type and initial value of each kind of value
+#define DSW_TYPE_TEXT          String
+#define DSW_TYPE_UNIX          uint32_t
+#define DSW_TYPE_U16           uint16_t
+#define DSW_TYPE_PCT           uint8_t
+#define DSW_TYPE_ICON          uint8_t
+#define DSW_TYPE_PTYPE         uint8_t
+#define DSW_TYPE_FLOAT         float
+#define DSW_TYPE_TEMP          float
+#define DSW_TYPE_PRESS         float
+#define DSW_TYPE_RATE          float
+#define DSW_TYPE_ACCUM         float
+#define DSW_TYPE_SPEED         float
+
+#define DSW_INIT_TEXT          String()
+#define DSW_INIT_UNIX          0
+#define DSW_INIT_U16           0
+#define DSW_INIT_PCT           0
+#define DSW_INIT_ICON          0
+#define DSW_INIT_PTYPE         NO_VALUE
+#define DSW_INIT_FLOAT         0
+#define DSW_INIT_TEMP          0
+#define DSW_INIT_PRESS         0
+#define DSW_INIT_RATE          0
+#define DSW_INIT_ACCUM         0
+#define DSW_INIT_SPEED         0
+
+// Value set by reset(), a String is emptied so it keeps its buffer
+#define DSW_RESET_TEXT         ""
+#define DSW_RESET_UNIX         DSW_INIT_UNIX
+#define DSW_RESET_U16          DSW_INIT_U16
+#define DSW_RESET_PCT          DSW_INIT_PCT
+#define DSW_RESET_ICON         DSW_INIT_ICON
+#define DSW_RESET_PTYPE        DSW_INIT_PTYPE
+#define DSW_RESET_FLOAT        DSW_INIT_FLOAT
+#define DSW_RESET_TEMP         DSW_INIT_TEMP
+#define DSW_RESET_PRESS        DSW_INIT_PRESS
+#define DSW_RESET_RATE         DSW_INIT_RATE
+#define DSW_RESET_ACCUM        DSW_INIT_ACCUM
+#define DSW_RESET_SPEED        DSW_INIT_SPEED
+
+// Storage for each kind of value
+#define DSW_SCALAR_TEXT(m)     String   m
+#define DSW_SCALAR_UNIX(m)     uint32_t m = 0
+#define DSW_SCALAR_U16(m)      uint16_t m = 0
+#define DSW_SCALAR_PCT(m)      uint8_t  m = 0
+#define DSW_SCALAR_ICON(m)     uint8_t  m = 0
+#define DSW_SCALAR_PTYPE(m)    uint8_t  m = NO_VALUE
+#define DSW_SCALAR_FLOAT(m)    float    m = 0
+#define DSW_SCALAR_TEMP(m)     float    m = 0
+#define DSW_SCALAR_PRESS(m)    float    m = 0
+#define DSW_SCALAR_RATE(m)     float    m = 0
+#define DSW_SCALAR_ACCUM(m)    float    m = 0
+#define DSW_SCALAR_SPEED(m)    float    m = 0
+
+#define DSW_ARRAY_TEXT(m, N)   String   m[N]
+#define DSW_ARRAY_UNIX(m, N)   uint32_t m[N] = { 0 }
+#define DSW_ARRAY_U16(m, N)    uint16_t m[N] = { 0 }
+#define DSW_ARRAY_PCT(m, N)    uint8_t  m[N] = { 0 }
+#define DSW_ARRAY_ICON(m, N)   uint8_t  m[N] = { 0 }
+#define DSW_ARRAY_PTYPE(m, N)  uint8_t  m[N] = { NO_VALUE }
+#define DSW_ARRAY_FLOAT(m, N)  float    m[N] = { 0 }
+#define DSW_ARRAY_TEMP(m, N)   float    m[N] = { 0 }
+#define DSW_ARRAY_PRESS(m, N)  float    m[N] = { 0 }
+#define DSW_ARRAY_RATE(m, N)   float    m[N] = { 0 }
+#define DSW_ARRAY_ACCUM(m, N)  float    m[N] = { 0 }
+#define DSW_ARRAY_SPEED(m, N)  float    m[N] = { 0 }
+
+// Unselected data points are empty base classes so take no space in the final struct
+#define DSW_SCALAR_MEMBER(S, s, m, k, kind)                                             \
+  template <bool on> struct dsw_##s##_##m {                                             \
+    void dswBind(dsw_binding_t &) {}                                                    \
+    void dswReset() {}                                                                  \
+  };                                                                                    \
+  template <> struct dsw_##s##_##m<true> {                                              \
+    DSW_SCALAR_##kind(m);                                                               \
+    void dswBind(dsw_binding_t &b) { b.slot[DSW_FIELD_##s##_##m] = &m; }                \
+    void dswReset() { m = DSW_RESET_##kind; }                                           \
+  };
+
+#define DSW_ARRAY_MEMBER(S, s, m, k, kind)                                              \
+  template <bool on, uint16_t N> struct dsw_##s##_##m##_a {                            \
+    void dswBind(dsw_binding_t &) {}                                                    \
+    void dswReset(uint16_t) {}                                                          \
+  };                                                                                    \
+  template <uint16_t N> struct dsw_##s##_##m##_a<true, N> {                             \
+    DSW_ARRAY_##kind(m, N);                                                             \
+    void dswBind(dsw_binding_t &b) { b.slot[DSW_FIELD_##s##_##m] = m; }                 \
+    void dswReset(uint16_t n) { for (uint16_t i = 0; i < n; i++) m[i] = DSW_RESET_##kind; } \
+  };
+
+DSW_CURRENT_SCALARS(DSW_SCALAR_MEMBER, CURRENT, current)
+DSW_MINUTELY_SCALARS(DSW_SCALAR_MEMBER, MINUTELY, minutely)
+DSW_MINUTELY_ARRAYS(DSW_ARRAY_MEMBER, MINUTELY, minutely)
+DSW_HOURLY_SCALARS(DSW_SCALAR_MEMBER, HOURLY, hourly)
+DSW_HOURLY_ARRAYS(DSW_ARRAY_MEMBER, HOURLY, hourly)
+DSW_DAILY_SCALARS(DSW_SCALAR_MEMBER, DAILY, daily)
+DSW_DAILY_ARRAYS(DSW_ARRAY_MEMBER, DAILY, daily)
+
+// Base class list and bind calls for a struct with data point mask F (and size N)
+#define DSW_SCALAR_BASE(S, s, m, k, kind) public dsw_##s##_##m<(F & DSW_##S##_##m) != 0>,
+#define DSW_ARRAY_BASE(S, s, m, k, kind)  public dsw_##s##_##m##_a<(F & DSW_##S##_##m) != 0, N>,
+#define DSW_SCALAR_BIND(S, s, m, k, kind) dsw_##s##_##m<(F & DSW_##S##_##m) != 0>::dswBind(b);
+#define DSW_ARRAY_BIND(S, s, m, k, kind)  dsw_##s##_##m##_a<(F & DSW_##S##_##m) != 0, N>::dswBind(b);
+#define DSW_SCALAR_RESET(S, s, m, k, kind) dsw_##s##_##m<(F & DSW_##S##_##m) != 0>::dswReset();
+#define DSW_ARRAY_RESET(S, s, m, k, kind)  dsw_##s##_##m##_a<(F & DSW_##S##_##m) != 0, N>::dswReset(records);
+
+struct dsw_fields_end {};
 
 /***************************************************************************************
 ** Description:   Structure for current weather
 ***************************************************************************************/
-typedef struct TFT_current {
-
-  //String   timezone;
-  uint32_t time = 0;
-  String   summary;
-  uint8_t  icon = 0;
-  //float    precipIntensity = 0;
-  //uint8_t  precipType = NO_VALUE;
-  //uint8_t  precipProbability = 0;
-  float    temperature = 0;
-  uint8_t  humidity = 0;
-  float    pressure = 0;
-  float    windSpeed = 0;
-  //float    windGust = 0;
-  uint16_t windBearing = 0;
-  uint8_t  cloudCover = 0;
-} TFT_current;
+template <uint32_t F = DSW_CURRENT_ALL>
+struct DSW_current_t : DSW_CURRENT_SCALARS(DSW_SCALAR_BASE, CURRENT, current) dsw_fields_end {
+
+  static const uint32_t fields = F;
+
+  void dswBind(dsw_binding_t &b) {
+    DSW_CURRENT_SCALARS(DSW_SCALAR_BIND, CURRENT, current)
+    b.fields[DSW_CURRENT] = F;
+  }
+
+  // Set the values back to the defaults so the struct can be reused for the next forecast
+  void reset() {
+    DSW_CURRENT_SCALARS(DSW_SCALAR_RESET, CURRENT, current)
+  }
+};
 
 /***************************************************************************************
 ** Description:   Structure for minutely weather
 ***************************************************************************************/
-#define MAX_MINUTES 60 // Can be up to 60 - not used by TFT_eSPI
-typedef struct TFT_minutely {
+template <uint32_t F = DSW_MINUTELY_ALL, uint16_t N = MAX_MINUTES>
+struct DSW_minutely_t : DSW_MINUTELY_SCALARS(DSW_SCALAR_BASE, MINUTELY, minutely)
+                        DSW_MINUTELY_ARRAYS(DSW_ARRAY_BASE, MINUTELY, minutely) dsw_fields_end {
+
+  static const uint32_t fields = F;
+  static const uint16_t size = N;
 
-  //String   overallSummary;
-  //uint8_t  icon = 0;
-  //uint32_t time[MAX_MINUTES] = { 0 }; // seems like a waste to store these....
-  //float    precipIntensity[MAX_MINUTES] = { 0 };
-  //uint8_t  precipProbability[MAX_MINUTES] = { 0 };
+  uint16_t records = 0; // "data" elements holding values, counted from 0
 
-} TFT_minutely;
+  void dswBind(dsw_binding_t &b) {
+    DSW_MINUTELY_SCALARS(DSW_SCALAR_BIND, MINUTELY, minutely)
+    DSW_MINUTELY_ARRAYS(DSW_ARRAY_BIND, MINUTELY, minutely)
+    b.fields[DSW_MINUTELY] = F;
+    b.size[DSW_MINUTELY] = N;
+    b.records[DSW_MINUTELY] = &records;
+  }
+
+  // Set the values back to the defaults so the struct can be reused for the next
+  // forecast, only the array elements that were filled are reset
+  void reset() {
+    DSW_MINUTELY_SCALARS(DSW_SCALAR_RESET, MINUTELY, minutely)
+    DSW_MINUTELY_ARRAYS(DSW_ARRAY_RESET, MINUTELY, minutely)
+    records = 0;
+  }
+};
 
 /***************************************************************************************
 ** Description:   Structure for hourly weather
 ***************************************************************************************/
-#define MAX_HOURS 24 // Can be up to 48 - not used by TFT_eSPI
-typedef struct TFT_hourly {
+template <uint32_t F = DSW_HOURLY_ALL, uint16_t N = MAX_HOURS>
+struct DSW_hourly_t : DSW_HOURLY_SCALARS(DSW_SCALAR_BASE, HOURLY, hourly)
+                      DSW_HOURLY_ARRAYS(DSW_ARRAY_BASE, HOURLY, hourly) dsw_fields_end {
+
+  static const uint32_t fields = F;
+  static const uint16_t size = N;
 
-  //String   overallSummary;
+  uint16_t records = 0; // "data" elements holding values, counted from 0
 
-  //String   summary[MAX_HOURS];
-  //uint32_t time[MAX_HOURS] = { 0 };
-  //float    precipIntensity[MAX_HOURS] = { 0 };
-  //uint8_t  precipType[MAX_HOURS] = { NO_VALUE };
-  //uint8_t  precipProbability[MAX_HOURS] = { 0 };
-  //float    precipAccumulation[MAX_HOURS] = { 0 };
-  //float    temperature[MAX_HOURS] = { 0 };
-  //float    pressure[MAX_HOURS] = { 0 };
-  //uint8_t  cloudCover[MAX_HOURS] = { 0 };
+  void dswBind(dsw_binding_t &b) {
+    DSW_HOURLY_SCALARS(DSW_SCALAR_BIND, HOURLY, hourly)
+    DSW_HOURLY_ARRAYS(DSW_ARRAY_BIND, HOURLY, hourly)
+    b.fields[DSW_HOURLY] = F;
+    b.size[DSW_HOURLY] = N;
+    b.records[DSW_HOURLY] = &records;
+  }
 
-} TFT_hourly;
+  // Set the values back to the defaults so the struct can be reused for the next
+  // forecast, only the array elements that were filled are reset
+  void reset() {
+    DSW_HOURLY_SCALARS(DSW_SCALAR_RESET, HOURLY, hourly)
+    DSW_HOURLY_ARRAYS(DSW_ARRAY_RESET, HOURLY, hourly)
+    records = 0;
+  }
+};
 
 /***************************************************************************************
 ** Description:   Structure for daily weather
 ***************************************************************************************/
-#define MAX_DAYS 5 // Today + 7 days = 8 maximum, make it 5 for TFT_eSPI example
-typedef struct TFT_daily {
-
-  String   overallSummary;
-
-  String   summary[MAX_DAYS];
-  uint32_t time[MAX_DAYS] = { 0 };
-  uint8_t  icon[MAX_DAYS] = { 0 };
-  uint32_t sunriseTime[MAX_DAYS] = { 0 };
-  uint32_t sunsetTime[MAX_DAYS] = { 0 };
-  uint8_t  moonPhase[MAX_DAYS] = { 0 };
-  //float    precipIntensity[MAX_DAYS] = { 0 };
-  //uint8_t  precipProbability[MAX_DAYS] = { 0 };
-  //uint8_t  precipType[MAX_DAYS] = { NO_VALUE };
-  //float    precipAccumulation[MAX_DAYS] = { 0 };
-  float    temperatureHigh[MAX_DAYS] = { 0 };
-  float    temperatureLow[MAX_DAYS] = { 0 };
-  //uint8_t  humidity[MAX_DAYS] = { 0 };
-  //float    pressure[MAX_DAYS] = { 0 };
-  //float    windSpeed[MAX_DAYS] = { 0 };
-  //float    windGust[MAX_DAYS] = { 0 };
-  //uint16_t windBearing[MAX_DAYS] = { 0 };
-  //uint8_t  cloudCover[MAX_DAYS] = { 0 };
-
-} TFT_daily;
-
-#endif
\ No newline at end of file
+template <uint32_t F = DSW_DAILY_ALL, uint16_t N = MAX_DAYS>
+struct DSW_daily_t : DSW_DAILY_SCALARS(DSW_SCALAR_BASE, DAILY, daily)
+                     DSW_DAILY_ARRAYS(DSW_ARRAY_BASE, DAILY, daily) dsw_fields_end {
+
+  static const uint32_t fields = F;
+  static const uint16_t size = N;
+
+  uint16_t records = 0; // "data" elements holding values, counted from 0
+
+  void dswBind(dsw_binding_t &b) {
+    DSW_DAILY_SCALARS(DSW_SCALAR_BIND, DAILY, daily)
+    DSW_DAILY_ARRAYS(DSW_ARRAY_BIND, DAILY, daily)
+    b.fields[DSW_DAILY] = F;
+    b.size[DSW_DAILY] = N;
+    b.records[DSW_DAILY] = &records;
+  }
+
+  // Set the values back to the defaults so the struct can be reused for the next
+  // forecast, only the array elements that were filled are reset
+  void reset() {
+    DSW_DAILY_SCALARS(DSW_SCALAR_RESET, DAILY, daily)
+    DSW_DAILY_ARRAYS(DSW_ARRAY_RESET, DAILY, daily)
+    records = 0;
+  }
+};
+
+/***************************************************************************************
+** Description:   Structure for one "data" array element of any section
+***************************************************************************************/
+// Used by streamForecast(), the library fills this record as each data point is parsed
+// and passes it to a sketch callback, so no forecast arrays need to be stored. Members
+// not sent for a section (e.g. temperatureHigh for hourly) are left at their defaults.
+
+// Masks of the data points held in arrays, these are the ones passed to the callback
+#define DSW_MASK_OR(S, s, m, k, kind) | DSW_##S##_##m
+#define DSW_MINUTELY_POINT (0 DSW_MINUTELY_ARRAYS(DSW_MASK_OR, MINUTELY, minutely))
+#define DSW_HOURLY_POINT   (0 DSW_HOURLY_ARRAYS(DSW_MASK_OR, HOURLY, hourly))
+#define DSW_DAILY_POINT    (0 DSW_DAILY_ARRAYS(DSW_MASK_OR, DAILY, daily))
+
+#define DSW_POINT_BIND(S, s, m, k, kind) b.slot[DSW_FIELD_##s##_##m] = &m;
+
+typedef struct DSW_datapoint {
+
+  // Declared with the same kinds as the data point lists so the stored types match
+  DSW_SCALAR_UNIX(time);
+  DSW_SCALAR_TEXT(summary);
+  DSW_SCALAR_ICON(icon);
+  DSW_SCALAR_UNIX(sunriseTime);
+  DSW_SCALAR_UNIX(sunsetTime);
+  DSW_SCALAR_PCT(moonPhase);
+  DSW_SCALAR_RATE(precipIntensity);
+  DSW_SCALAR_PCT(precipProbability);
+  DSW_SCALAR_PTYPE(precipType);
+  DSW_SCALAR_ACCUM(precipAccumulation);
+  DSW_SCALAR_TEMP(temperature);
+  DSW_SCALAR_TEMP(temperatureHigh);
+  DSW_SCALAR_TEMP(temperatureLow);
+  DSW_SCALAR_PCT(humidity);
+  DSW_SCALAR_PRESS(pressure);
+  DSW_SCALAR_SPEED(windSpeed);
+  DSW_SCALAR_SPEED(windGust);
+  DSW_SCALAR_U16(windBearing);
+  DSW_SCALAR_PCT(cloudCover);
+
+  // Point the array data points of a section at this record
+  void dswBind(dsw_binding_t &b, uint8_t section) {
+    switch (section) {
+      case DSW_MINUTELY:
+        DSW_MINUTELY_ARRAYS(DSW_POINT_BIND, MINUTELY, minutely)
+        b.fields[DSW_MINUTELY] |= DSW_MINUTELY_POINT;
+        break;
+      case DSW_HOURLY:
+        DSW_HOURLY_ARRAYS(DSW_POINT_BIND, HOURLY, hourly)
+        b.fields[DSW_HOURLY] |= DSW_HOURLY_POINT;
+        break;
+      case DSW_DAILY:
+        DSW_DAILY_ARRAYS(DSW_POINT_BIND, DAILY, daily)
+        b.fields[DSW_DAILY] |= DSW_DAILY_POINT;
+        break;
+      default: break;
+    }
+  }
+
+  // Set back to defaults ready for the next data point, the summary keeps its buffer
+  void clear() {
+    time = sunriseTime = sunsetTime = 0;
+    summary = "";
+    icon = moonPhase = precipProbability = humidity = cloudCover = 0;
+    precipType = NO_VALUE;
+    precipIntensity = precipAccumulation = temperature = temperatureHigh = temperatureLow = 0;
+    pressure = windSpeed = windGust = 0;
+    windBearing = 0;
+  }
+
+} DSW_datapoint;
+
+/***************************************************************************************
+** Description:   Default structures
+***************************************************************************************/
+#ifndef MINIMISE_DATA_POINTS // Full set of values populated if not defined
+
+typedef DSW_current_t<>  DSW_current;
+typedef DSW_minutely_t<> DSW_minutely;
+typedef DSW_hourly_t<>   DSW_hourly;
+typedef DSW_daily_t<>    DSW_daily;
+
+#else // Collect minimal set of data points for TFT_eSPI examples to reduce RAM needs
+
+typedef DSW_current_t<DSW_CURRENT_TFT>   DSW_current;
+typedef DSW_minutely_t<DSW_MINUTELY_TFT> DSW_minutely; // Not used by TFT_eSPI
+typedef DSW_hourly_t<DSW_HOURLY_TFT>     DSW_hourly;   // Not used by TFT_eSPI
+typedef DSW_daily_t<DSW_DAILY_TFT>       DSW_daily;
+
+#endif
+
+#endif
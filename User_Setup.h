@@ -14,21 +14,37 @@
 #define MAX_DAYS 8     // Maximum "daily" forecast periods can be 1 to 8 (Today + 7 days = 8 maximum)
                        // TFT_eSPI example requires this to be >= 5 (today + 4 forecast days)
 
+#define DSW_BUFFER_SIZE 1024 // Bytes read from the secure client per block, 128 to 4096
+
+#define DSW_MAX_DEPTH 6 // JSON object/array nesting tracked by the parser, 4 needed for "daily/data"
+
+//#define USE_JSON_DECODER // Parse with the JSON_Decoder library via the JsonListener virtual
+                           // callbacks instead of the faster built in DSW_Parser
+
 // #define MINIMISE_DATA_POINTS // option to minimise stored values for TFT_eSPI_Weather example
 
 // Note: If MINIMISE_DATA_POINTS is defined and the "DarkSkyWeather_Test" example
 // compiled then a compile error "no member named..." will occur in  since data points
 // will be missing!  Unfortnately compile time options for a library cannot be set in a
-// sketch when using the Arduino IDE.
+// sketch when using the Arduino IDE. Instead a sketch can select the data points it
+// needs with the DSW_current_t<> etc templates, see Data_Point_Set.h
 
 //#define AXTLS       // For ESP8266 only: use older axTLS secure client instead of BearSSL
 //#define SECURE_SSL  // For ESP8266 only: use SHA1 fingerprint with BearSSL
 
+//#define DSW_KEEP_ALIVE // Keep the secure client and socket open between forecast requests
+                         // (HTTP/1.1 keep-alive) so the TLS handshake is not repeated. With
+                         // BearSSL the TLS session is also kept and offered for resumption
+                         // if the server has closed the socket. Uses heap for the client
+                         // between requests, see closeConnection()
+
 
 //#define SHOW_HEADER   // Debug only - for checking response header via serial message
 //#define SHOW_JSON     // Debug only - simple serial output formatting of whole JSON message
 //#define SHOW_CALLBACK // Debug only to show the decode tree
 
+//#define DSW_STD_THREAD // Test only - build DSW_Background.h and DSW_Ring.h with std::thread, e.g. on a PC
+
 // ###############################################################################
 // DO NOT tinker below, this is configuration checking that helps stop crashes:
 // ###############################################################################
@@ -50,3 +66,15 @@
   #undef  MAX_DAYS
   #define MAX_DAYS 8  // Ignore compiler warning!
 #endif
+
+// Check and correct bad setting
+#if (DSW_BUFFER_SIZE > 4096) || (DSW_BUFFER_SIZE < 128)
+  #undef  DSW_BUFFER_SIZE
+  #define DSW_BUFFER_SIZE 1024 // Ignore compiler warning!
+#endif
+
+// Check and correct bad setting, the array level flags are 8 bits
+#if (DSW_MAX_DEPTH > 8) || (DSW_MAX_DEPTH < 4)
+  #undef  DSW_MAX_DEPTH
+  #define DSW_MAX_DEPTH 6 // Ignore compiler warning!
+#endif
@@ -0,0 +1,69 @@
+// Sketch for ESP8266 and ESP32 to compare the parse time of the built in DSW_Parser
+// and the JSON_Decoder library, an example from the library here:
+// https://github.com/Bodmer/DarkSkyWeather
+
+// No WiFi connection is needed, a forecast message held in memory (Sample_JSON.h) is
+// parsed repeatedly with each parser and the time per message byte is reported.
+
+// DSW_Parser is bound to the DS_Weather class at compile time so the callbacks are
+// direct (inlined) calls, JSON_Decoder calls them via the JsonListener virtual functions.
+
+#include <JSON_Decoder.h>
+
+#include <DarkSkyWeather.h>
+
+#include "Sample_JSON.h"
+
+#define PASSES 20 // Number of times the message is parsed by each parser
+
+DS_Weather dsw; // Weather forecast library instance
+
+void setup() {
+  Serial.begin(250000);
+  delay(100);
+
+  DSW_current *current = new DSW_current;
+  DSW_hourly  *hourly  = new DSW_hourly;
+  DSW_daily   *daily   = new DSW_daily;
+
+  size_t length = sizeof(sampleJSON) - 1;
+
+  Serial.print("\nMessage length : "); Serial.print(length); Serial.println(" bytes\n");
+
+  benchmark("DSW_Parser   ", current, hourly, daily, length, false);
+  benchmark("JSON_Decoder ", current, hourly, daily, length, true);
+
+  // Check the values were decoded
+  Serial.print("\nCurrent temperature : "); Serial.println(current->temperature);
+  Serial.print("Tomorrow            : "); Serial.println(daily->summary[1]);
+
+  delete current;
+  delete hourly;
+  delete daily;
+}
+
+void loop() {
+}
+
+/***************************************************************************************
+**                          Time one of the parsers
+***************************************************************************************/
+void benchmark(const char *name, DSW_current *current, DSW_hourly *hourly, DSW_daily *daily,
+               size_t length, bool useJsonDecoder)
+{
+  bool ok = true;
+
+  uint32_t dt = micros();
+  for (int i = 0; i < PASSES; i++)
+  {
+    ok &= dsw.parseForecast(current, nullptr, hourly, daily,
+                            (const uint8_t *)sampleJSON, length, useJsonDecoder);
+    yield();
+  }
+  dt = micros() - dt;
+
+  Serial.print(name);
+  Serial.print(ok ? "OK    " : "ERROR ");
+  Serial.print((float)dt / PASSES / length, 3); Serial.print(" us/byte, ");
+  Serial.print(dt / PASSES); Serial.println(" us/message");
+}
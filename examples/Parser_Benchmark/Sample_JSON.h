@@ -0,0 +1,118 @@
+// A Dark Sky forecast message used by the benchmark, current weather, 12 hours and 8 days
+
+const char sampleJSON[] =
+  "{\"latitude\":27.9881,\"longitude\":86.925,\"timezone\":\"Asia/Kathmandu\",\"currently\":{\"time\":157"
+  "1230800,\"summary\":\"Clear\",\"icon\":\"partly-cloudy-night\",\"precipIntensity\":0.7896,\"precipPro"
+  "bability\":0.05,\"temperature\":-2.18,\"apparentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.5"
+  "8,\"pressure\":1026.4,\"windSpeed\":2.58,\"windGust\":1.72,\"windBearing\":214,\"cloudCover\":0.07,\""
+  "uvIndex\":0,\"visibility\":10.0,\"ozone\":280.5,\"precipAccumulation\":0.425},\"hourly\":{\"summary\""
+  ":\"Mostly cloudy throughout the day.\",\"icon\":\"partly-cloudy-day\",\"data\":[{\"time\":1571230800"
+  ",\"summary\":\"Mostly Cloudy\",\"icon\":\"fog\",\"precipIntensity\":0.7525,\"precipProbability\":0.63,"
+  "\"temperature\":13.07,\"apparentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.47,\"pressure\":99"
+  "4.6,\"windSpeed\":5.86,\"windGust\":19.56,\"windBearing\":245,\"cloudCover\":0.48,\"uvIndex\":0,\"vis"
+  "ibility\":10.0,\"ozone\":280.5,\"precipAccumulation\":0.102},{\"time\":1571234400,\"summary\":\"Clea"
+  "r\",\"icon\":\"rain\",\"precipIntensity\":0.9572,\"precipProbability\":0.69,\"temperature\":1.16,\"app"
+  "arentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.95,\"pressure\":1004.5,\"windSpeed\":8.28,\"w"
+  "indGust\":18.28,\"windBearing\":270,\"cloudCover\":0.3,\"uvIndex\":0,\"visibility\":10.0,\"ozone\":28"
+  "0.5},{\"time\":1571238000,\"summary\":\"Partly Cloudy\",\"icon\":\"rain\",\"precipIntensity\":1.0368,\""
+  "precipProbability\":0.91,\"precipType\":\"rain\",\"temperature\":1.68,\"apparentTemperature\":1.5,\""
+  "dewPoint\":2.5,\"humidity\":0.54,\"pressure\":1010.1,\"windSpeed\":7.64,\"windGust\":12.26,\"windBea"
+  "ring\":99,\"cloudCover\":0.81,\"uvIndex\":0,\"visibility\":10.0,\"ozone\":280.5},{\"time\":1571241600"
+  ",\"summary\":\"Mostly Cloudy\",\"icon\":\"partly-cloudy-night\",\"precipIntensity\":1.0353,\"precipPr"
+  "obability\":0.36,\"precipType\":\"rain\",\"temperature\":-4.16,\"apparentTemperature\":1.5,\"dewPoin"
+  "t\":2.5,\"humidity\":0.28,\"pressure\":1000.4,\"windSpeed\":8.31,\"windGust\":19.13,\"windBearing\":2"
+  "28,\"cloudCover\":0.81,\"uvIndex\":0,\"visibility\":10.0,\"ozone\":280.5},{\"time\":1571245200,\"summ"
+  "ary\":\"Clear\",\"icon\":\"rain\",\"precipIntensity\":0.1611,\"precipProbability\":0.1,\"precipType\":\""
+  "rain\",\"temperature\":5.13,\"apparentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.48,\"pressur"
+  "e\":1029.4,\"windSpeed\":7.32,\"windGust\":0.04,\"windBearing\":334,\"cloudCover\":0.34,\"uvIndex\":0"
+  ",\"visibility\":10.0,\"ozone\":280.5},{\"time\":1571248800,\"summary\":\"Partly Cloudy\",\"icon\":\"clo"
+  "udy\",\"precipIntensity\":1.5646,\"precipProbability\":0.75,\"precipType\":\"rain\",\"temperature\":0"
+  ".36,\"apparentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.79,\"pressure\":1003.3,\"windSpeed\""
+  ":9.61,\"windGust\":19.43,\"windBearing\":202,\"cloudCover\":0.46,\"uvIndex\":0,\"visibility\":10.0,\""
+  "ozone\":280.5},{\"time\":1571252400,\"summary\":\"Partly Cloudy\",\"icon\":\"partly-cloudy-night\",\"p"
+  "recipIntensity\":0.34,\"precipProbability\":0.13,\"precipType\":\"rain\",\"temperature\":22.15,\"app"
+  "arentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.81,\"pressure\":995.8,\"windSpeed\":9.92,\"wi"
+  "ndGust\":19.61,\"windBearing\":336,\"cloudCover\":0.94,\"uvIndex\":0,\"visibility\":10.0,\"ozone\":28"
+  "0.5,\"precipAccumulation\":0.548},{\"time\":1571256000,\"summary\":\"Partly Cloudy\",\"icon\":\"clear"
+  "-day\",\"precipIntensity\":1.5987,\"precipProbability\":0.73,\"precipType\":\"rain\",\"temperature\":"
+  "17.48,\"apparentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.14,\"pressure\":1029.5,\"windSpee"
+  "d\":2.34,\"windGust\":17.48,\"windBearing\":14,\"cloudCover\":0.25,\"uvIndex\":0,\"visibility\":10.0,"
+  "\"ozone\":280.5,\"precipAccumulation\":0.241},{\"time\":1571259600,\"summary\":\"Overcast\",\"icon\":\""
+  "rain\",\"precipIntensity\":0.5187,\"precipProbability\":0.42,\"precipType\":\"rain\",\"temperature\":"
+  "22.3,\"apparentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.35,\"pressure\":1008.3,\"windSpeed"
+  "\":7.0,\"windGust\":18.09,\"windBearing\":215,\"cloudCover\":0.83,\"uvIndex\":0,\"visibility\":10.0,\""
+  "ozone\":280.5},{\"time\":1571263200,\"summary\":\"Mostly Cloudy\",\"icon\":\"fog\",\"precipIntensity\":"
+  "0.3037,\"precipProbability\":0.51,\"temperature\":18.3,\"apparentTemperature\":1.5,\"dewPoint\":2."
+  "5,\"humidity\":0.61,\"pressure\":1021.0,\"windSpeed\":1.8,\"windGust\":2.83,\"windBearing\":316,\"clo"
+  "udCover\":0.73,\"uvIndex\":0,\"visibility\":10.0,\"ozone\":280.5},{\"time\":1571266800,\"summary\":\"C"
+  "lear\",\"icon\":\"fog\",\"precipIntensity\":1.0615,\"precipProbability\":0.48,\"temperature\":21.5,\"a"
+  "pparentTemperature\":1.5,\"dewPoint\":2.5,\"humidity\":0.06,\"pressure\":997.7,\"windSpeed\":0.51,\""
+  "windGust\":1.95,\"windBearing\":231,\"cloudCover\":0.56,\"uvIndex\":0,\"visibility\":10.0,\"ozone\":2"
+  "80.5},{\"time\":1571270400,\"summary\":\"Partly Cloudy\",\"icon\":\"cloudy\",\"precipIntensity\":0.651"
+  "2,\"precipProbability\":0.97,\"temperature\":0.98,\"apparentTemperature\":1.5,\"dewPoint\":2.5,\"hu"
+  "midity\":0.28,\"pressure\":1010.3,\"windSpeed\":9.69,\"windGust\":10.16,\"windBearing\":126,\"cloudC"
+  "over\":0.7,\"uvIndex\":0,\"visibility\":10.0,\"ozone\":280.5}]},\"daily\":{\"summary\":\"Light rain on"
+  " Friday.\",\"icon\":\"rain\",\"data\":[{\"time\":1571230800,\"summary\":\"Mostly Cloudy\",\"icon\":\"cloud"
+  "y\",\"precipIntensity\":0.7133,\"precipProbability\":0.82,\"sunriseTime\":1571255800,\"sunsetTime\""
+  ":1571295800,\"moonPhase\":0.43,\"precipIntensityMax\":0.3,\"precipIntensityMaxTime\":1571234400,"
+  "\"temperatureHigh\":5.99,\"temperatureHighTime\":1571270800,\"temperatureLow\":2.1,\"temperatureL"
+  "owTime\":1571310800,\"apparentTemperatureHigh\":12.3,\"dewPoint\":4.5,\"humidity\":0.37,\"pressure"
+  "\":1026.8,\"windSpeed\":2.32,\"windGust\":7.28,\"windGustTime\":1571235800,\"windBearing\":242,\"clo"
+  "udCover\":0.03,\"uvIndex\":3,\"uvIndexTime\":1571273800,\"visibility\":16.09,\"ozone\":290.1,\"tempe"
+  "ratureMin\":1.0,\"temperatureMinTime\":1571250800,\"temperatureMax\":2.0,\"temperatureMaxTime\":1"
+  "571280800,\"precipAccumulation\":2.435},{\"time\":1571317200,\"summary\":\"Light Rain\",\"icon\":\"cl"
+  "ear-day\",\"precipIntensity\":0.7511,\"precipProbability\":0.46,\"sunriseTime\":1571342200,\"sunse"
+  "tTime\":1571382200,\"moonPhase\":0.06,\"precipIntensityMax\":0.3,\"precipIntensityMaxTime\":15713"
+  "20800,\"temperatureHigh\":8.9,\"temperatureHighTime\":1571357200,\"temperatureLow\":-4.06,\"tempe"
+  "ratureLowTime\":1571397200,\"apparentTemperatureHigh\":12.3,\"dewPoint\":4.5,\"humidity\":0.61,\"p"
+  "ressure\":1004.5,\"windSpeed\":4.02,\"windGust\":19.08,\"windGustTime\":1571322200,\"windBearing\":"
+  "22,\"cloudCover\":0.26,\"uvIndex\":3,\"uvIndexTime\":1571360200,\"visibility\":16.09,\"ozone\":290.1"
+  ",\"temperatureMin\":1.0,\"temperatureMinTime\":1571337200,\"temperatureMax\":2.0,\"temperatureMax"
+  "Time\":1571367200},{\"time\":1571403600,\"summary\":\"Clear\",\"icon\":\"rain\",\"precipIntensity\":0.5"
+  "948,\"precipProbability\":0.72,\"sunriseTime\":1571428600,\"sunsetTime\":1571468600,\"moonPhase\":"
+  "0.81,\"precipIntensityMax\":0.3,\"precipIntensityMaxTime\":1571407200,\"temperatureHigh\":23.93,"
+  "\"temperatureHighTime\":1571443600,\"temperatureLow\":-4.02,\"temperatureLowTime\":1571483600,\"a"
+  "pparentTemperatureHigh\":12.3,\"dewPoint\":4.5,\"humidity\":0.83,\"pressure\":994.3,\"windSpeed\":8"
+  ".59,\"windGust\":9.31,\"windGustTime\":1571408600,\"windBearing\":197,\"cloudCover\":0.79,\"uvIndex"
+  "\":3,\"uvIndexTime\":1571446600,\"visibility\":16.09,\"ozone\":290.1,\"temperatureMin\":1.0,\"temper"
+  "atureMinTime\":1571423600,\"temperatureMax\":2.0,\"temperatureMaxTime\":1571453600},{\"time\":157"
+  "1490000,\"summary\":\"Light Rain\",\"icon\":\"partly-cloudy-night\",\"precipIntensity\":1.8562,\"prec"
+  "ipProbability\":0.18,\"sunriseTime\":1571515000,\"sunsetTime\":1571555000,\"moonPhase\":0.74,\"pre"
+  "cipIntensityMax\":0.3,\"precipIntensityMaxTime\":1571493600,\"temperatureHigh\":21.46,\"temperat"
+  "ureHighTime\":1571530000,\"temperatureLow\":6.59,\"temperatureLowTime\":1571570000,\"apparentTem"
+  "peratureHigh\":12.3,\"dewPoint\":4.5,\"humidity\":0.61,\"pressure\":1003.1,\"windSpeed\":3.83,\"wind"
+  "Gust\":7.24,\"windGustTime\":1571495000,\"windBearing\":305,\"cloudCover\":0.08,\"uvIndex\":3,\"uvIn"
+  "dexTime\":1571533000,\"visibility\":16.09,\"ozone\":290.1,\"temperatureMin\":1.0,\"temperatureMinT"
+  "ime\":1571510000,\"temperatureMax\":2.0,\"temperatureMaxTime\":1571540000,\"precipAccumulation\":"
+  "2.259},{\"time\":1571576400,\"summary\":\"Mostly Cloudy\",\"icon\":\"cloudy\",\"precipIntensity\":0.12"
+  "95,\"precipProbability\":0.03,\"sunriseTime\":1571601400,\"sunsetTime\":1571641400,\"moonPhase\":0"
+  ".33,\"precipIntensityMax\":0.3,\"precipIntensityMaxTime\":1571580000,\"temperatureHigh\":24.61,\""
+  "temperatureHighTime\":1571616400,\"temperatureLow\":8.25,\"temperatureLowTime\":1571656400,\"app"
+  "arentTemperatureHigh\":12.3,\"dewPoint\":4.5,\"humidity\":0.99,\"pressure\":1000.6,\"windSpeed\":1."
+  "01,\"windGust\":1.93,\"windGustTime\":1571581400,\"windBearing\":255,\"cloudCover\":0.99,\"uvIndex\""
+  ":3,\"uvIndexTime\":1571619400,\"visibility\":16.09,\"ozone\":290.1,\"temperatureMin\":1.0,\"tempera"
+  "tureMinTime\":1571596400,\"temperatureMax\":2.0,\"temperatureMaxTime\":1571626400},{\"time\":1571"
+  "662800,\"summary\":\"Mostly Cloudy\",\"icon\":\"partly-cloudy-night\",\"precipIntensity\":0.2659,\"pr"
+  "ecipProbability\":0.46,\"sunriseTime\":1571687800,\"sunsetTime\":1571727800,\"moonPhase\":0.23,\"p"
+  "recipIntensityMax\":0.3,\"precipIntensityMaxTime\":1571666400,\"temperatureHigh\":15.77,\"temper"
+  "atureHighTime\":1571702800,\"temperatureLow\":6.61,\"temperatureLowTime\":1571742800,\"apparentT"
+  "emperatureHigh\":12.3,\"dewPoint\":4.5,\"humidity\":0.76,\"pressure\":1021.2,\"windSpeed\":3.53,\"wi"
+  "ndGust\":5.59,\"windGustTime\":1571667800,\"windBearing\":137,\"cloudCover\":0.37,\"uvIndex\":3,\"uv"
+  "IndexTime\":1571705800,\"visibility\":16.09,\"ozone\":290.1,\"temperatureMin\":1.0,\"temperatureMi"
+  "nTime\":1571682800,\"temperatureMax\":2.0,\"temperatureMaxTime\":1571712800},{\"time\":1571749200"
+  ",\"summary\":\"Mostly Cloudy\",\"icon\":\"cloudy\",\"precipIntensity\":0.4949,\"precipProbability\":0."
+  "25,\"precipType\":\"rain\",\"sunriseTime\":1571774200,\"sunsetTime\":1571814200,\"moonPhase\":0.88,\""
+  "precipIntensityMax\":0.3,\"precipIntensityMaxTime\":1571752800,\"temperatureHigh\":16.57,\"tempe"
+  "ratureHighTime\":1571789200,\"temperatureLow\":-0.1,\"temperatureLowTime\":1571829200,\"apparent"
+  "TemperatureHigh\":12.3,\"dewPoint\":4.5,\"humidity\":0.4,\"pressure\":1029.7,\"windSpeed\":6.09,\"wi"
+  "ndGust\":4.63,\"windGustTime\":1571754200,\"windBearing\":51,\"cloudCover\":0.65,\"uvIndex\":3,\"uvI"
+  "ndexTime\":1571792200,\"visibility\":16.09,\"ozone\":290.1,\"temperatureMin\":1.0,\"temperatureMin"
+  "Time\":1571769200,\"temperatureMax\":2.0,\"temperatureMaxTime\":1571799200},{\"time\":1571835600,"
+  "\"summary\":\"Partly Cloudy\",\"icon\":\"clear-day\",\"precipIntensity\":0.9495,\"precipProbability\":"
+  "0.82,\"sunriseTime\":1571860600,\"sunsetTime\":1571900600,\"moonPhase\":0.91,\"precipIntensityMax"
+  "\":0.3,\"precipIntensityMaxTime\":1571839200,\"temperatureHigh\":5.81,\"temperatureHighTime\":157"
+  "1875600,\"temperatureLow\":-0.59,\"temperatureLowTime\":1571915600,\"apparentTemperatureHigh\":1"
+  "2.3,\"dewPoint\":4.5,\"humidity\":0.12,\"pressure\":997.6,\"windSpeed\":11.68,\"windGust\":11.66,\"wi"
+  "ndGustTime\":1571840600,\"windBearing\":38,\"cloudCover\":0.37,\"uvIndex\":3,\"uvIndexTime\":157187"
+  "8600,\"visibility\":16.09,\"ozone\":290.1,\"temperatureMin\":1.0,\"temperatureMinTime\":1571855600"
+  ",\"temperatureMax\":2.0,\"temperatureMaxTime\":1571885600}]},\"offset\":5.75}";
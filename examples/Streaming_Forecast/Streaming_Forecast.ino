@@ -0,0 +1,118 @@
+// Sketch for ESP8266 and ESP32 to stream the Weather Forecast from Dark Sky
+// an example from the library here:
+// https://github.com/Bodmer/DarkSkyWeather
+
+// Sign up for a key and read API configuration info here:
+// https://darksky.net/dev
+
+// The hourly and daily forecasts are passed to a callback function one data point at a
+// time, so the 48 hour forecast can be used without storing the DSW_hourly arrays.
+
+// Choose library to load
+#ifdef ESP8266
+  #include <ESP8266WiFi.h>
+  #include <WiFiClientSecure.h>
+#else // ESP32
+  #include <WiFi.h>
+#endif
+
+#include <JSON_Decoder.h>
+
+#include <DarkSkyWeather.h>
+
+// =====================================================
+// ========= User configured stuff starts here =========
+
+// Change to suit your WiFi router
+#define SSID "Your_SSID"
+#define SSID_PASSWORD "Your_password"
+
+// Dark Sky API Details, replace x's with your API key
+String api_key = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"; // Obtain this from your Dark Sky account
+
+// Set both longitude and latitude to at least 4 decimal places
+String latitude =  "27.9881"; // 90.0000 to -90.0000 negative for Southern hemisphere
+String longitude = "86.9250"; // 180.000 to -180.000 negative for West
+
+String units = "si";  // See notes tab of DarkSkyWeather_Test
+String language = "";
+
+// =========  User configured stuff ends here  =========
+// =====================================================
+
+DS_Weather dsw; // Weather forecast library instance
+
+// Running values collected from the streamed data points
+float    maxTemperature;
+uint32_t maxTime;
+uint8_t  rainHours;
+
+void setup() {
+  Serial.begin(250000);
+
+  Serial.printf("Connecting to %s\n", SSID);
+
+  WiFi.begin(SSID, SSID_PASSWORD);
+
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(500);
+    Serial.print(".");
+  }
+
+  Serial.println();
+  Serial.print("Connected\n");
+}
+
+void loop() {
+
+  printForecast();
+
+  // We can make 1000 requests a day
+  delay(5 * 60 * 1000); // Every 5 minutes = 288 requests per day
+}
+
+/***************************************************************************************
+**                          Called for each data point
+***************************************************************************************/
+void dataPoint(uint8_t section, uint16_t index, const DSW_datapoint &point)
+{
+  if (section == DSW_HOURLY)
+  {
+    if (index == 0 || point.temperature > maxTemperature)
+    {
+      maxTemperature = point.temperature;
+      maxTime = point.time;
+    }
+    if (point.precipProbability >= 50) rainHours++;
+  }
+  else if (section == DSW_DAILY)
+  {
+    Serial.print("Day "); Serial.print(index); Serial.print(" : ");
+    Serial.print(point.temperatureLow); Serial.print(" to ");
+    Serial.print(point.temperatureHigh); Serial.print(", ");
+    Serial.println(point.summary);
+  }
+}
+
+/***************************************************************************************
+**                          Send weather info to serial port
+***************************************************************************************/
+void printForecast()
+{
+  // Only the current weather is stored
+  DSW_current *current = new DSW_current;
+
+  rainHours = 0;
+
+  Serial.print("\nRequesting weather information from DarkSky.net... ");
+
+  dsw.streamForecast(current, DSW_STREAM_HOURLY | DSW_STREAM_DAILY, dataPoint,
+                     api_key, latitude, longitude, units, language);
+
+  Serial.print("Current temperature      : "); Serial.println(current->temperature);
+  Serial.print("48 hour max temperature  : "); Serial.println(maxTemperature);
+  Serial.print("Max temperature time     : "); Serial.println(maxTime);
+  Serial.print("Hours with rain >= 50%   : "); Serial.println(rainHours);
+
+  delete current;
+}
@@ -69,11 +69,16 @@ TFT_eSPI tft = TFT_eSPI();             // Invoke custom library
 
 DS_Weather dsw;      // Weather forcast library instance
 
-DSW_current *current; // Pointers to structs that temporarily holds weather data
-DSW_hourly  *hourly;  // Not used
-DSW_daily   *daily;
+// Only the data points used by this sketch are stored, see library Data_Point_Set.h
+typedef DSW_current_t<DSW_CURRENT_TFT> TFT_current;
+typedef DSW_daily_t<DSW_DAILY_TFT>     TFT_daily;
+
+TFT_current *current = nullptr; // Pointers to structs that hold the weather data, they
+DSW_hourly  *hourly  = nullptr; // are created once and reused for every update so the
+TFT_daily   *daily   = nullptr; // heap does not fragment, hourly is not used
 
 boolean booted = true;
+boolean updating = false; // true while dsw.poll() fetches the weather
 
 GfxUi ui = GfxUi(&tft); // Jpeg and bmpDraw functions TODO: pull outside of a class
 
@@ -82,7 +87,9 @@ long lastDownloadUpdate = millis();
 /***************************************************************************************
 **                          Declare prototypes
 ***************************************************************************************/
-void updateData();
+void startUpdate();
+void pollUpdate();
+void updateScreen(bool parsed);
 void drawProgress(uint8_t percentage, String text);
 void drawTime();
 void drawCurrentWeather();
@@ -170,13 +177,18 @@ void setup() {
 ***************************************************************************************/
 void loop() {
 
-  // Check if we should update weather information
-  if (booted || (millis() - lastDownloadUpdate > 1000UL * UPDATE_INTERVAL_SECS))
+  // Check if we should update weather information, dsw.poll() then fetches it a block
+  // at a time so the clock and screen server keep running
+  if (!updating && (booted || (millis() - lastDownloadUpdate > 1000UL * UPDATE_INTERVAL_SECS)))
   {
-    updateData();
-    lastDownloadUpdate = millis();
+    startUpdate();
   }
 
+  // At boot there is nothing else to show so wait for the weather
+  do {
+    if (updating) pollUpdate();
+  } while (booted && updating);
+
   // If minute has changed then request new time from NTP server
   if (booted || minute() != lastMinute)
   {
@@ -196,10 +208,10 @@ void loop() {
 }
 
 /***************************************************************************************
-**                          Fetch the weather data  and update screen
+**                          Start fetching the weather data
 ***************************************************************************************/
-// Update the internet based information and update screen
-void updateData() {
+// Start the internet based information update, pollUpdate() completes it
+void startUpdate() {
   // booted = true;  // Test only
   // booted = false; // Test only
 
@@ -211,12 +223,15 @@ void updateData() {
   if (booted) drawProgress(50, "Updating conditions...");
   else fillSegment(22, 22, 0, (int) (50 * 3.6), 16, TFT_NAVY);
 
-  // Create the structures that hold the retrieved weather
-  current = new DSW_current;
-  daily =   new DSW_daily;
+  // Create the structures that hold the retrieved weather on the first update, after
+  // that reset() clears the values from the last update ready for reuse
+  if (!current) current = new TFT_current;
+  else current->reset();
+
+  if (!daily) daily = new TFT_daily;
+  else daily->reset();
 
-  // hourly not used by this sketch, set to nullptr
-  hourly =  nullptr; //new DSW_hourly;
+  // hourly not used by this sketch, it stays nullptr
 
 #ifdef RANDOM_LOCATION // Randomly choose a place on Earth to test icons etc
   String latitude = "";
@@ -225,7 +240,31 @@ void updateData() {
   longitude = (random(360) - 180);
 #endif
 
-  bool parsed = dsw.getForecast(current, hourly, daily, api_key, latitude, longitude, units, language);
+  updating = dsw.beginForecast(current, nullptr, hourly, daily, api_key, latitude, longitude, units, language);
+  if (!updating) lastDownloadUpdate = millis();
+
+  tft.unloadFont();
+}
+
+/***************************************************************************************
+**                          Fetch the next part of the weather data
+***************************************************************************************/
+void pollUpdate() {
+  uint8_t state = dsw.poll();
+  if (state < DSW_FETCH_DONE) return;
+
+  updating = false;
+  lastDownloadUpdate = millis();
+
+  updateScreen(state == DSW_FETCH_DONE);
+}
+
+/***************************************************************************************
+**                          Update screen with the new weather data
+***************************************************************************************/
+void updateScreen(bool parsed) {
+
+  tft.loadFont(AA_FONT_SMALL);
 
   printWeather(); // For debug, turn on output with #define SERIAL_MESSAGES
 
@@ -245,9 +284,11 @@ void updateData() {
 
   if (parsed)
   {
-    drawCurrentWeather();
-    drawForecast();
-    drawAstronomy();
+    // The structs are reused so only the areas with changed values need to be redrawn,
+    // after booting the screen has been cleared so everything is drawn
+    if (booted || dsw.changes(DSW_CURRENT)) drawCurrentWeather();
+    if (booted || dsw.changes(DSW_DAILY))   drawForecast();
+    if (booted || dsw.changed())            drawAstronomy();
 
     tft.unloadFont();
 
@@ -269,11 +310,6 @@ void updateData() {
     Serial.println("Failed to get weather");
   }
 
-  // Delete to free up space
-  delete current;
-  delete hourly;
-  delete daily;
-
   tft.unloadFont();
 }
 
@@ -410,8 +446,10 @@ void drawCurrentWeather() {
 ***************************************************************************************/
 // draws the three forecast columns
 void drawForecast() {
-  int8_t dayIndex = 1;
-  //while ((daily->time[dayIndex] < (current->time - 12*60*60UL)) && (dayIndex < (MAX_DAYS - 4))) dayIndex++;
+  // Start the day after the one holding the current time (a binary search of daily->time)
+  DSW_query<DSW_minutely, DSW_hourly, TFT_daily> query(nullptr, nullptr, daily);
+  int16_t today = query.index(DSW_DAILY, current->time);
+  int8_t dayIndex = (today < 0) ? 1 : today + 1;
   drawForecastDetail(  8, 171, dayIndex++);
   drawForecastDetail( 66, 171, dayIndex++); // was 95
   drawForecastDetail(124, 171, dayIndex++); // was 180
@@ -458,10 +496,10 @@ void drawAstronomy() {
   tft.setTextColor(TFT_WHITE, TFT_BLACK);
   tft.setTextPadding(tft.textWidth(" Last qtr "));
 
-  int8_t dayIndex = 0;
-
-  //The first daily summary might be yesterday, maybe search for time > now
-  //while ((daily->time[dayIndex] < current->time) && (dayIndex < MAX_DAYS)) dayIndex++;
+  // The first daily summary might be yesterday, so find the day holding the current time
+  DSW_query<DSW_minutely, DSW_hourly, TFT_daily> query(nullptr, nullptr, daily);
+  int16_t today = query.index(DSW_DAILY, current->time);
+  int8_t dayIndex = (today < 0) ? 0 : today;
 
   uint8_t moonIndex = (uint8_t)(((float)daily->moonPhase[dayIndex] + 6.25) / 12.5);
   if (moonIndex > 7) moonIndex = 0;
@@ -0,0 +1,165 @@
+// Stress test of DSW_background on a PC, not part of the library. Build from the library
+// folder and run with:
+//
+//   g++ -std=gnu++11 -O1 -g -pthread -fsanitize=thread -DESP8266 -DDSW_STD_THREAD -Iextras/test/host -I. extras/test/background_stress.cpp extras/test/host/host.cpp DarkSkyWeather.cpp -o background_stress && ./background_stress
+//
+// The fetch task refreshes as fast as it can from a fake server while two reader threads
+// acquire() the newest forecast, check every value came from one response, hold it for a
+// while and check it again. It fails if a held forecast changes, a forecast mixes two
+// responses, generation() goes backwards or a truncated response is published. Then the
+// same response is served repeatedly and no data point may be reported as changed.
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <JSON_Decoder.h>
+
+#include "DarkSkyWeather.h"
+#include "DSW_Background.h"
+#include "forecast_json.h"
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+typedef DSW_background<DSW_current, DSW_none, DSW_hourly, DSW_daily> Weather;
+
+static Weather weather;
+
+static std::atomic<uint32_t> served { 0 };
+static std::atomic<uint32_t> truncated { 0 };
+static std::atomic<bool>     stop { false };
+
+// Every 7th response is cut short, it must fail and not be published
+static std::string serve(const std::string &)
+{
+  uint32_t version = ++served;
+  std::string body = forecastJson(version);
+
+  if (version % 7 == 0)
+  {
+    truncated++;
+    return httpResponse(body.substr(0, body.size() / 2));
+  }
+
+  return httpResponse(body, version & 1);
+}
+
+// Version of f, 0 if its values are not all from that one response
+static uint32_t versionOf(const Weather::forecast_t *f)
+{
+  uint32_t version = f->current.time - DSW_TEST_TIME;
+
+  if (f->current.temperature != testTemperature(version, 0)) return 0;
+
+  for (uint16_t i = 0; i < f->hourly.size; i++)
+  {
+    if (f->hourly.time[i] != testTime(version, 3600, i)) return 0;
+    if (f->hourly.temperature[i] != testTemperature(version, i)) return 0;
+  }
+
+  for (uint16_t i = 0; i < f->daily.size; i++)
+  {
+    if (f->daily.time[i] != testTime(version, 86400, i)) return 0;
+    if (f->daily.temperatureHigh[i] != testTemperature(version, i)) return 0;
+  }
+
+  return version;
+}
+
+struct Reader {
+  uint32_t reads = 0;
+  uint32_t errors = 0;
+
+  void run(unsigned seed)
+  {
+    uint32_t lastGeneration = 0, lastSet = 0;
+
+    while (!stop)
+    {
+      uint32_t generation = weather.generation();
+      if (generation < lastGeneration) errors++;
+      lastGeneration = generation;
+
+      const Weather::forecast_t *f = weather.acquire();
+      if (!f) { std::this_thread::yield(); continue; }
+
+      // The set acquired is never older than the last one, nor newer than published
+      if (f->generation < lastSet || f->generation > weather.generation()) errors++;
+      lastSet = f->generation;
+
+      uint32_t version = versionOf(f);
+      if (version == 0 || version % 7 == 0) errors++;
+
+      // Every response differs from the others
+      if (!(f->changes[DSW_CURRENT] & DSW_CURRENT_time) || !(f->changes[DSW_HOURLY] & DSW_HOURLY_temperature)) errors++;
+
+      // Hold it, sometimes across several refreshes, then check nothing moved
+      seed = seed * 1103515245 + 12345;
+      uint32_t hold = (seed >> 8) % 3000;
+      if ((seed >> 20) % 8 == 0) hold *= 100;
+      std::this_thread::sleep_for(std::chrono::microseconds(hold));
+      if (versionOf(f) != version || f->generation != lastSet) errors++;
+
+      weather.release(f);
+      reads++;
+    }
+  }
+};
+
+int main()
+{
+  dswHostServe = serve;
+  dswHostTrickle = 700;
+
+  if (!weather.begin("key", "51.5", "-0.12", "si", "en", 0))
+  {
+    printf("background_stress: task not started: FAIL\n");
+    return 1;
+  }
+
+  Reader a, b;
+  std::thread ta(&Reader::run, &a, 1u);
+  std::thread tb(&Reader::run, &b, 2u);
+
+  // Ask for more refreshes while the readers run
+  for (int i = 0; i < 40; i++)
+  {
+    weather.refresh();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  stop = true;
+  ta.join();
+  tb.join();
+  weather.end();
+
+  uint32_t errors = a.errors + b.errors;
+  bool pass = errors == 0 && weather.generation() > 10 && weather.failures() == truncated
+              && weather.generation() + weather.failures() == served && !weather.running();
+
+  printf("background_stress: %u responses, %u generations, %u failures (%u truncated), %u reads, %u errors: %s\n",
+         (unsigned)served, (unsigned)weather.generation(), (unsigned)weather.failures(),
+         (unsigned)truncated, (unsigned)(a.reads + b.reads), (unsigned)errors, pass ? "PASS" : "FAIL");
+
+  // Identical responses, once both sets have held one nothing has changed
+  static const std::string response = httpResponse(forecastJson(1000));
+  dswHostServe = [](const std::string &) { return response; };
+  weather.begin("key", "51.5", "-0.12", "si", "en", 0);
+  uint32_t first = weather.generation();
+  while (weather.generation() < first + 4 && weather.running())
+  {
+    weather.refresh();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  weather.end();
+
+  const Weather::forecast_t *f = weather.acquire();
+  uint32_t changes = f->changes[DSW_CURRENT] | f->changes[DSW_HOURLY] | f->changes[DSW_DAILY];
+  weather.release(f);
+  bool same = !changes && weather.generation() >= first + 4;
+  pass = pass && same;
+
+  printf("background_stress: repeated response, changes 0x%x: %s\n", (unsigned)changes, same ? "PASS" : "FAIL");
+
+  return pass ? 0 : 1;
+}
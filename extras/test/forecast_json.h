@@ -0,0 +1,76 @@
+// Canned forecast responses for the host tests, not part of the library
+
+// Every value is made from a version number and the data point index, so a test can tell
+// from any struct which response it came from and whether it was filled by only one.
+
+#ifndef DSW_Forecast_JSON_h
+#define DSW_Forecast_JSON_h
+
+#include <string>
+
+#define DSW_TEST_TIME  1500000000UL
+#define DSW_TEST_HOURS 48
+#define DSW_TEST_DAYS  8
+
+// Values of a version
+inline uint32_t testTime(uint32_t version, uint32_t step, uint16_t i) { return DSW_TEST_TIME + version + step * i; }
+inline float    testTemperature(uint32_t version, uint16_t i) { return (float)((version + i) % 500) + 0.5f; }
+
+inline std::string forecastJson(uint32_t version)
+{
+  char b[256];
+  std::string json = "{\"latitude\":51.5,\"longitude\":-0.12,\"timezone\":\"Europe/London\",";
+
+  snprintf(b, sizeof(b), "\"currently\":{\"time\":%lu,\"summary\":\"Version %lu\",\"icon\":\"rain\","
+           "\"temperature\":%.1f,\"humidity\":0.5,\"pressure\":1012.5,\"windSpeed\":3.25,\"windBearing\":270},",
+           (unsigned long)testTime(version, 0, 0), (unsigned long)version, testTemperature(version, 0));
+  json += b;
+
+  json += "\"hourly\":{\"summary\":\"Hourly\",\"icon\":\"rain\",\"data\":[";
+  for (uint16_t i = 0; i < DSW_TEST_HOURS; i++)
+  {
+    snprintf(b, sizeof(b), "%s{\"time\":%lu,\"summary\":\"Hour %u\",\"icon\":\"cloudy\",\"precipIntensity\":0.125,"
+             "\"precipProbability\":0.25,\"temperature\":%.1f,\"pressure\":1010.5,\"cloudCover\":0.75}",
+             i ? "," : "", (unsigned long)testTime(version, 3600, i), i, testTemperature(version, i));
+    json += b;
+  }
+  json += "]},";
+
+  json += "\"daily\":{\"summary\":\"Daily\",\"icon\":\"rain\",\"data\":[";
+  for (uint16_t i = 0; i < DSW_TEST_DAYS; i++)
+  {
+    snprintf(b, sizeof(b), "%s{\"time\":%lu,\"summary\":\"Day %u\",\"icon\":\"clear-day\",\"moonPhase\":0.5,"
+             "\"temperatureHigh\":%.1f,\"temperatureLow\":1.5,\"windBearing\":90}",
+             i ? "," : "", (unsigned long)testTime(version, 86400, i), i, testTemperature(version, i));
+    json += b;
+  }
+  json += "]},\"flags\":{\"units\":\"si\"},\"offset\":0}";
+
+  return json;
+}
+
+// HTTP response carrying body, with chunked framing of up to 300 bytes per chunk if chunked
+inline std::string httpResponse(const std::string &body, bool chunked = false)
+{
+  char b[64];
+  std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n";
+
+  if (!chunked)
+  {
+    snprintf(b, sizeof(b), "Content-Length: %u\r\n\r\n", (unsigned)body.size());
+    return response + b + body;
+  }
+
+  response += "Transfer-Encoding: chunked\r\n\r\n";
+  for (size_t p = 0; p < body.size(); )
+  {
+    size_t n = 1 + (p * 7) % 300;
+    if (n > body.size() - p) n = body.size() - p;
+    snprintf(b, sizeof(b), "%x\r\n", (unsigned)n);
+    response += b + body.substr(p, n) + "\r\n";
+    p += n;
+  }
+  return response + "0\r\n\r\n";
+}
+
+#endif
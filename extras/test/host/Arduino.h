@@ -0,0 +1,100 @@
+// Host stand-in for the Arduino core, only what the DarkSkyWeather library uses, so the
+// tests in extras/test build on a PC. Not part of the library.
+
+#ifndef DSW_Host_Arduino_h
+#define DSW_Host_Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+
+typedef bool boolean;
+
+#define PROGMEM
+#define F(x) x
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+
+unsigned long millis();
+unsigned long micros();
+void yield();
+void delay(unsigned long ms);
+
+class String {
+  public:
+    String() { }
+    String(const char *c) : s(c ? c : "") { }
+    String(const std::string &c) : s(c) { }
+    String(char c) : s(1, c) { }
+    String(int v) : s(std::to_string(v)) { }
+    String(unsigned v) : s(std::to_string(v)) { }
+    String(long v) : s(std::to_string(v)) { }
+    String(unsigned long v) : s(std::to_string(v)) { }
+    String(double v, int d = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", d, v); s = b; }
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned length() const { return s.size(); }
+    bool reserve(unsigned n) { s.reserve(n); return true; }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+    int indexOf(const char *x, int from = 0) const { size_t p = s.find(x, from); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(char x, int from = 0) const { size_t p = s.find(x, from); return p == std::string::npos ? -1 : (int)p; }
+    bool startsWith(const char *x) const { return s.compare(0, strlen(x), x) == 0; }
+    String substring(unsigned a) const { return s.substr(a); }
+    String substring(unsigned a, unsigned b) const { return s.substr(a, b - a); }
+    void toLowerCase() { for (char &c : s) c = tolower(c); }
+    void trim() { }
+    bool concat(const char *c, unsigned n) { s.append(c, n); return true; }
+    bool concat(char c) { s += c; return true; }
+
+    bool operator==(const char *o) const { return s == o; }
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator!=(const char *o) const { return s != o; }
+    bool operator!=(const String &o) const { return s != o.s; }
+    String &operator+=(const String &o) { s += o.s; return *this; }
+    String &operator+=(const char *o) { s += o; return *this; }
+    String &operator+=(char o) { s += o; return *this; }
+    String &operator+=(int o) { s += std::to_string(o); return *this; }
+    String &operator+=(unsigned o) { s += std::to_string(o); return *this; }
+    char operator[](unsigned i) const { return s[i]; }
+
+    std::string s;
+};
+
+inline String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+inline String operator+(const String &a, const char *b) { return String(a.s + b); }
+inline String operator+(const char *a, const String &b) { return String(a + b.s); }
+
+// Serial output is dropped unless dswHostVerbose is set
+extern bool dswHostVerbose;
+
+class Print {
+  public:
+    void begin(unsigned long) { }
+    void print(const String &x) { out("%s", x.c_str()); }
+    void print(const char *x) { out("%s", x); }
+    void print(char x) { out("%c", x); }
+    void print(unsigned char x) { out("%u", x); }
+    void print(int x) { out("%d", x); }
+    void print(unsigned x) { out("%u", x); }
+    void print(long x) { out("%ld", x); }
+    void print(unsigned long x) { out("%lu", x); }
+    void print(long long x) { out("%lld", x); }
+    void print(unsigned long long x) { out("%llu", x); }
+    void print(double x, int d = 2) { out("%.*f", d, x); }
+    template <class T> void println(const T &x) { print(x); out("\n"); }
+    void println(double x, int d) { print(x, d); out("\n"); }
+    void println() { out("\n"); }
+    void printf(const char *f, ...) __attribute__((format(printf, 2, 3)));
+  private:
+    void out(const char *f, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern Print Serial;
+
+#endif
@@ -0,0 +1,19 @@
+// Host stand-in for the JSON_Decoder library, the tests use the built in DSW_Parser.
+// Building with USE_JSON_DECODER needs the real library on the include path instead.
+
+#ifndef DSW_Host_JSON_Decoder_h
+#define DSW_Host_JSON_Decoder_h
+
+#include "JSON_Listener.h"
+
+class JSON_Decoder {
+  public:
+    void setListener(JsonListener *listener) { this->listener = listener; }
+    void reset() { failed = false; }
+    void parse(char) { if (!failed) listener->error("JSON_Decoder is not built on the host"); failed = true; }
+  private:
+    JsonListener *listener = nullptr;
+    bool failed = false;
+};
+
+#endif
@@ -0,0 +1,22 @@
+// Host stand-in for the JsonListener interface of the JSON_Decoder library
+// https://github.com/Bodmer/JSON_Decoder
+
+#ifndef DSW_Host_JSON_Listener_h
+#define DSW_Host_JSON_Listener_h
+
+class JsonListener {
+  public:
+    virtual ~JsonListener() { }
+    virtual void whitespace(char c) = 0;
+    virtual void startDocument() = 0;
+    virtual void key(const char *key) = 0;
+    virtual void value(const char *value) = 0;
+    virtual void endArray() = 0;
+    virtual void endObject() = 0;
+    virtual void endDocument() = 0;
+    virtual void startArray() = 0;
+    virtual void startObject() = 0;
+    virtual void error(const char *message) = 0;
+};
+
+#endif
@@ -0,0 +1,44 @@
+// Host stand-in for the secure client. There is no network, each request is answered by
+// the test's dswHostServe() function and the response is handed out dswHostTrickle
+// bytes at a time, as a slow connection would.
+
+#ifndef DSW_Host_WiFiClientSecure_h
+#define DSW_Host_WiFiClientSecure_h
+
+#include <Arduino.h>
+
+// Response for a request (the GET line and headers), set by the test
+extern std::string (*dswHostServe)(const std::string &request);
+extern size_t dswHostTrickle;   // Most bytes available() reports at once
+extern unsigned dswHostReadCost; // Busy loop iterations per byte read, stands in for TLS
+
+class WiFiClientSecure {
+  public:
+    int connect(const char *, int) { open = true; request.clear(); response.clear(); pos = 0; return 1; }
+    size_t print(const String &s);
+    int available() { size_t a = open ? response.size() - pos : 0; return (int)(a > dswHostTrickle ? dswHostTrickle : a); }
+    uint8_t connected() { return open && pos < response.size(); }
+    int read(uint8_t *buffer, size_t n);
+    void stop() { open = false; }
+    void setInsecure() { }
+    void setCACert(const char *) { }
+    void setTimeout(unsigned long) { }
+    operator bool() { return open; }
+
+  private:
+    bool open = false;
+    std::string request, response;
+    size_t pos = 0;
+};
+
+namespace BearSSL {
+  class Session { };
+  class WiFiClientSecure : public ::WiFiClientSecure {
+    public:
+      void setFingerprint(const uint8_t *) { }
+      void setSession(Session *) { }
+      void setBufferSizes(int, int) { }
+  };
+}
+
+#endif
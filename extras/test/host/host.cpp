@@ -0,0 +1,75 @@
+// Host stand-in for the Arduino core and secure client, see Arduino.h
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+
+Print Serial;
+bool  dswHostVerbose = false;
+
+std::string (*dswHostServe)(const std::string &request) = nullptr;
+size_t   dswHostTrickle  = 1460; // A TCP segment
+unsigned dswHostReadCost = 0;
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long micros()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void yield()
+{
+  std::this_thread::yield();
+}
+
+void delay(unsigned long ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void Print::printf(const char *f, ...)
+{
+  if (!dswHostVerbose) return;
+  va_list a; va_start(a, f); vprintf(f, a); va_end(a);
+}
+
+void Print::out(const char *f, ...)
+{
+  if (!dswHostVerbose) return;
+  va_list a; va_start(a, f); vprintf(f, a); va_end(a);
+}
+
+// The response is made when the blank line ending the request header is sent
+size_t WiFiClientSecure::print(const String &s)
+{
+  request += s.s;
+  if (request.find("\r\n\r\n") != std::string::npos)
+  {
+    response = dswHostServe ? dswHostServe(request) : std::string();
+    request.clear();
+    pos = 0;
+  }
+  return s.length();
+}
+
+int WiFiClientSecure::read(uint8_t *buffer, size_t n)
+{
+  size_t a = response.size() - pos;
+  if (n > a) n = a;
+
+  volatile unsigned spin = 0;
+  for (size_t i = 0; i < n * dswHostReadCost; i++) spin = spin + 1;
+
+  memcpy(buffer, response.data() + pos, n);
+  pos += n;
+  return (int)n;
+}
@@ -0,0 +1,335 @@
+// Unit test of DSW_inflate and compressed forecasts on a PC, not part of the library.
+// Needs zlib to make the test streams. Build from the library folder and run with:
+//
+//   g++ -std=gnu++11 -O1 -g -fsanitize=address,undefined -DESP8266 -Iextras/test/host -I. extras/test/inflate_test.cpp extras/test/host/host.cpp DarkSkyWeather.cpp -lz -o inflate_test && ./inflate_test
+//
+// Add -pthread -DDSW_STD_THREAD to also fetch through the receive/parse pipeline.
+//
+// Streams made by zlib in the gzip, zlib and raw deflate formats, at each level and
+// strategy, are inflated with the input split from 1 byte at a time up to the whole
+// stream and compared with the original. Corrupt streams must fail cleanly, the
+// sanitizers catch any read or write outside the buffers. Then forecasts are fetched
+// gzip compressed, including one that needs a larger window than the inflater has.
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <JSON_Decoder.h>
+
+#include "DarkSkyWeather.h"
+#include "forecast_json.h"
+
+#include <zlib.h>
+
+static int failures = 0;
+
+#define CHECK(x) do { if (!(x)) { failures++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+#define FORMAT_GZIP 16 // Added to the zlib windowBits
+#define FORMAT_RAW  -1 // Multiplies the zlib windowBits
+
+static uint32_t seed = 12345;
+static uint32_t random32() { seed = seed * 1103515245UL + 12345; return seed >> 8; }
+
+/***************************************************************************************
+** Description:   Compress with zlib, windowBits as deflateInit2()
+***************************************************************************************/
+static std::string compress(const std::string &data, int level, int windowBits, int strategy,
+                            bool headerFields = false)
+{
+  z_stream z = {};
+  if (deflateInit2(&z, level, Z_DEFLATED, windowBits, 8, strategy) != Z_OK) return "";
+
+  gz_header h = {};
+  char name[] = "forecast.json", comment[] = "test";
+  Bytef extra[] = { 'D', 'S', 2, 0, 1, 2 };
+  if (headerFields)
+  {
+    h.name = (Bytef *)name; h.comment = (Bytef *)comment;
+    h.extra = extra; h.extra_len = sizeof(extra); h.hcrc = 1;
+    deflateSetHeader(&z, &h);
+  }
+
+  std::string out(deflateBound(&z, data.size()) + 64, '\0');
+  z.next_in   = (Bytef *)data.data();
+  z.avail_in  = data.size();
+  z.next_out  = (Bytef *)&out[0];
+  z.avail_out = out.size();
+
+  int result = deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+
+  return (result == Z_STREAM_END) ? out : "";
+}
+
+/***************************************************************************************
+** Description:   Inflate z, step input bytes per call. false on an error
+***************************************************************************************/
+// A call that uses no input and gives no output must only happen once the input given
+// is used up, otherwise the decoder has stalled
+static bool decompress(DSW_inflate &inf, const std::string &z, size_t step, std::string &out)
+{
+  inf.begin();
+  out.clear();
+
+  const uint8_t *in = (const uint8_t *)z.data();
+  size_t pos = 0;
+
+  while (pos < z.size())
+  {
+    int count = (int)((z.size() - pos < step) ? z.size() - pos : step);
+    const uint8_t *p = in + pos;
+
+    for (;;)
+    {
+      const uint8_t *data;
+      int n;
+      int used = inf.inflate(p, count, &data, &n);
+
+      if (used < 0 || used > count || n < 0 || (uint32_t)n > inf.windowSize()) return false;
+      out.append((const char *)data, n);
+      p += used;
+      count -= used;
+      pos += used;
+
+      if (inf.error()) return false;
+      if (!used && !n)
+      {
+        if (count && !inf.done()) return false; // Stalled
+        break;
+      }
+    }
+
+    if (inf.done()) break;
+  }
+
+  return inf.done() && !inf.error();
+}
+
+/***************************************************************************************
+** Description:   Each format, level and strategy, input split every way
+***************************************************************************************/
+static void testStreams(const std::string &data, const char *name)
+{
+  static DSW_inflate_t<32768> inf;
+  static const int    levels[]     = { 0, 1, 6, 9 };
+  static const int    strategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED };
+  static const int    formats[]    = { FORMAT_GZIP, 0, FORMAT_RAW };
+  static const size_t steps[]      = { 1, 2, 3, 7, 64, 1460, 0xFFFFFFFF };
+
+  int streams = 0;
+  for (int format : formats) for (int level : levels) for (int strategy : strategies)
+  {
+    int windowBits = (format == FORMAT_RAW) ? -15 : 15 + format;
+    std::string z = compress(data, level, windowBits, strategy);
+    CHECK(z.size() > 0);
+
+    for (size_t step : steps)
+    {
+      std::string out;
+      bool ok = decompress(inf, z, step, out);
+      CHECK(ok && out == data);
+      if (!ok || out != data)
+        printf("  %s format %d level %d strategy %d step %u: error %u, %u of %u bytes\n", name, format,
+               level, strategy, (unsigned)step, inf.error(), (unsigned)out.size(), (unsigned)data.size());
+      CHECK(inf.bytesIn() == z.size() && inf.bytesOut() == data.size());
+    }
+    streams++;
+  }
+
+  // gzip header with every optional field
+  std::string out;
+  std::string z = compress(data, 6, 15 + FORMAT_GZIP, Z_DEFAULT_STRATEGY, true);
+  CHECK(decompress(inf, z, 1, out) && out == data);
+  CHECK(decompress(inf, z, z.size(), out) && out == data);
+
+  // A stream made with a 1 kbyte window inflates with a 1 kbyte window
+  static DSW_inflate_t<1024> small;
+  z = compress(data, 9, 10, Z_DEFAULT_STRATEGY);
+  CHECK(decompress(small, z, 5, out) && out == data);
+  CHECK(small.maxDistance() <= 1024);
+
+  printf("%s: %u bytes, %d streams\n", name, (unsigned)data.size(), streams);
+}
+
+/***************************************************************************************
+** Description:   Errors reported
+***************************************************************************************/
+static void testErrors()
+{
+  static DSW_inflate_t<1024> small;
+  static DSW_inflate_t<32768> large;
+  std::string out;
+
+  // Repeats 4 kbytes back need a window of more than 1 kbyte
+  std::string block, data;
+  for (int i = 0; i < 4096; i++) block += (char)('a' + random32() % 26);
+  data = block + block + block;
+  std::string z = compress(data, 9, 15 + FORMAT_GZIP, Z_DEFAULT_STRATEGY);
+
+  CHECK(!decompress(small, z, 100, out) && small.error() == DSW_INFLATE_WINDOW);
+  CHECK(decompress(large, z, 100, out) && out == data && large.maxDistance() == 4096);
+
+  // gzip size check, the trailer ends with the uncompressed size
+  std::string bad = z;
+  bad[bad.size() - 4] ^= 1;
+  CHECK(!decompress(large, bad, 100, out) && large.error() == DSW_INFLATE_LENGTH);
+
+  // Not a stream
+  CHECK(!decompress(large, "{\"latitude\":51.5}", 1, out) && large.error() == DSW_INFLATE_FORMAT);
+
+  // Cut short, the decoder waits for more input
+  CHECK(!decompress(large, z.substr(0, z.size() / 2), 64, out) && !large.error() && !large.done());
+}
+
+/***************************************************************************************
+** Description:   Corrupt streams fail or end, without stalling or a buffer overrun
+***************************************************************************************/
+static void testFuzz(const std::string &data)
+{
+  static DSW_inflate_t<4096> inf;
+  const int    windowBits[] = { 15 + FORMAT_GZIP, 15, -15 };
+  const int    levels[]     = { 1, 6, 9 };
+  const int    strategies[] = { Z_DEFAULT_STRATEGY, Z_HUFFMAN_ONLY, Z_FIXED };
+
+  uint32_t ended = 0, failed = 0, stalled = 0, runs = 0;
+
+  for (int w : windowBits) for (int level : levels) for (int strategy : strategies)
+  {
+    std::string z = compress(data, level, w, strategy);
+
+    for (int i = 0; i < 300; i++)
+    {
+      std::string bad = z;
+
+      switch (random32() % 4)
+      {
+        case 0: bad[random32() % bad.size()] ^= (char)(1 << (random32() % 8)); break; // Bit flip
+        case 1: for (int k = 0; k < 8; k++) bad[random32() % bad.size()] = (char)random32(); break;
+        case 2: bad.resize(random32() % bad.size()); break;                           // Truncated
+        case 3: // Random bytes after the header, the block headers are nonsense
+          for (size_t k = 10; k < bad.size(); k++) bad[k] = (char)random32();
+          break;
+      }
+
+      std::string out;
+      size_t step = 1 + random32() % 600;
+      if (decompress(inf, bad, step, out)) ended++;
+      else if (inf.error()) failed++;
+      else if (inf.done() || inf.bytesIn() < bad.size()) stalled++;
+      CHECK(inf.error() <= DSW_INFLATE_LENGTH);
+      runs++;
+    }
+  }
+
+  CHECK(stalled == 0);
+  printf("fuzz: %u corrupt streams, %u decoded, %u errors, %u stalled\n",
+         (unsigned)runs, (unsigned)ended, (unsigned)failed, (unsigned)stalled);
+}
+
+/***************************************************************************************
+** Description:   Forecasts fetched compressed, the server answers gzip when asked
+***************************************************************************************/
+static std::string body;
+static uint32_t requests = 0, gzipRequests = 0;
+
+static std::string serve(const std::string &request)
+{
+  requests++;
+  if (request.find("Accept-Encoding: gzip") == std::string::npos) return httpResponse(body, requests & 1);
+
+  gzipRequests++;
+  std::string z = compress(body, 9, 15 + FORMAT_GZIP, Z_DEFAULT_STRATEGY);
+  char b[96];
+  snprintf(b, sizeof(b), "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: %u\r\n\r\n", (unsigned)z.size());
+  return b + z;
+}
+
+static void testForecasts()
+{
+  static DSW_inflate_t<32768> large;
+  static DSW_inflate_t<256>   tiny;
+  DS_Weather ref, dsw;
+  DSW_current rc, c;
+  DSW_hourly  rh, h;
+  DSW_daily   rd, d;
+
+  dswHostServe = serve;
+  body = forecastJson(7);
+  CHECK(ref.parseForecast(&rc, (DSW_minutely *)nullptr, &rh, &rd, (const uint8_t *)body.data(), body.size()));
+
+  // Compressed
+  dsw.setInflater(&large);
+  requests = gzipRequests = 0;
+  CHECK(dsw.getForecast(&c, &h, &d, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(requests == 1 && gzipRequests == 1 && large.bytesOut() == body.size());
+  CHECK(c.temperature == rc.temperature && h.temperature[23] == rh.temperature[23] && d.summary[7] == rd.summary[7]);
+  uint16_t needed = large.maxDistance();
+  CHECK(needed > 256);
+
+  // A window too small, asked for again uncompressed straight away
+  dsw.setInflater(&tiny);
+  requests = gzipRequests = 0;
+  c.reset(); h.reset(); d.reset();
+  CHECK(dsw.getForecast(&c, &h, &d, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(requests == 2 && gzipRequests == 1 && tiny.error() == DSW_INFLATE_WINDOW);
+  CHECK(c.temperature == rc.temperature && h.temperature[23] == rh.temperature[23] && d.summary[7] == rd.summary[7]);
+
+  // Then gzip is not asked for
+  requests = gzipRequests = 0;
+  CHECK(dsw.getForecast(&c, &h, &d, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(requests == 1 && gzipRequests == 0);
+
+  // The same through poll()
+  dsw.setInflater(&tiny);
+  requests = gzipRequests = 0;
+  c.reset(); h.reset(); d.reset();
+  CHECK(dsw.beginForecast(&c, (DSW_minutely *)nullptr, &h, &d, "key", "51.5", "-0.12", "si", "en"));
+  // A blocking request may not take over the binding while it runs
+  DSW_current other;
+  CHECK(!dsw.getForecast(&other, (DSW_hourly *)nullptr, (DSW_daily *)nullptr, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(!dsw.parseForecast(&other, (DSW_minutely *)nullptr, (DSW_hourly *)nullptr, (DSW_daily *)nullptr,
+                           (const uint8_t *)body.data(), body.size()));
+  CHECK(!dsw.streamForecast(&other, 0, nullptr, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(requests == 0 && other.time == 0);
+
+  uint8_t state;
+  do state = dsw.poll(); while (state != DSW_FETCH_DONE && state != DSW_FETCH_FAILED);
+  CHECK(state == DSW_FETCH_DONE && requests == 2 && gzipRequests == 1);
+  CHECK(c.temperature == rc.temperature && h.temperature[23] == rh.temperature[23] && d.summary[7] == rd.summary[7]);
+
+#ifdef DSW_PIPELINE
+  // And through the receive/parse pipeline
+  static DSW_ring_t<1024> ring;
+  dsw.setPipeline(&ring);
+  dsw.setInflater(&tiny);
+  requests = gzipRequests = 0;
+  c.reset(); h.reset(); d.reset();
+  CHECK(dsw.getForecast(&c, &h, &d, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(requests == 2 && gzipRequests == 1 && tiny.error() == DSW_INFLATE_WINDOW);
+  CHECK(c.temperature == rc.temperature && h.temperature[23] == rh.temperature[23] && d.summary[7] == rd.summary[7]);
+  dsw.setPipeline(nullptr);
+#endif
+
+  printf("forecast: %u bytes, window needed %u\n", (unsigned)body.size(), (unsigned)needed);
+}
+
+int main()
+{
+  std::string text;
+  for (uint32_t v = 1; v <= 3; v++) text += forecastJson(v);
+
+  std::string noise;
+  for (int i = 0; i < 40000; i++) noise += (char)(random32() >> 4);
+
+  testStreams(text, "forecasts");
+  testStreams(noise, "random bytes");
+  testStreams(std::string(), "empty");
+  testStreams(std::string(70000, 'x'), "one byte repeated");
+  testErrors();
+  testFuzz(forecastJson(1));
+  testForecasts();
+
+  printf("inflate_test: %d failures: %s\n", failures, failures ? "FAIL" : "PASS");
+  return failures ? 1 : 0;
+}
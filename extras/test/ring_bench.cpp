@@ -0,0 +1,117 @@
+// Benchmark of DSW_ring and the receive/parse pipeline on a PC, not part of the library.
+// Build from the library folder and run with:
+//
+//   g++ -std=gnu++11 -O2 -pthread -DESP8266 -DDSW_STD_THREAD -Iextras/test/host -I. extras/test/ring_bench.cpp extras/test/host/host.cpp DarkSkyWeather.cpp -o ring_bench && ./ring_bench [read cost]
+//
+// Prints the throughput of the ring alone between two threads, then the time per
+// forecast with the pipeline off and on. The read cost (busy loop iterations per byte
+// read, default 20) stands in for the TLS decrypt the pipeline overlaps with the parse,
+// with 0 only the hand over between the threads is measured.
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <JSON_Decoder.h>
+
+#include "DarkSkyWeather.h"
+#include "forecast_json.h"
+
+#include <thread>
+#include <chrono>
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed(bench_clock::time_point t0)
+{
+  return std::chrono::duration<double>(bench_clock::now() - t0).count();
+}
+
+/***************************************************************************************
+** Description:   Bytes through the ring alone, 1460 byte writes as from the client
+***************************************************************************************/
+static void benchRing(DSW_ring &ring, uint32_t total)
+{
+  ring.begin();
+
+  bench_clock::time_point t0 = bench_clock::now();
+  std::thread consumer([&] {
+    uint32_t sum = 0;
+    for (;;)
+    {
+      const uint8_t *p;
+      uint32_t n = ring.peek(&p);
+      if (n) { sum += p[0]; ring.consume(n); continue; }
+      bool end = ring.finished();
+      if (!ring.available())
+      {
+        if (end) break;
+        ring.waitForData();
+      }
+    }
+    ring.close();
+    if (sum == 1) printf(" ");  // Keep the reads
+  });
+
+  static uint8_t block[1460];
+  for (uint32_t sent = 0; sent < total; )
+  {
+    uint32_t k = ring.write(block, sizeof(block));
+    if (!k) ring.waitForSpace();
+    sent += k;
+  }
+  ring.finish();
+  consumer.join();
+
+  double s = elapsed(t0);
+  printf("ring %5u: %7.1f Mbyte/s, peak %u, full waits %u, empty waits %u\n", ring.size(),
+         ring.bytesWritten() / s / 1e6, ring.peak(), ring.fullWaits(), ring.emptyWaits());
+}
+
+/***************************************************************************************
+** Description:   Time per forecast with the pipeline off (ring nullptr) and on
+***************************************************************************************/
+static std::string response;
+static std::string serve(const std::string &) { return response; }
+
+static void benchForecast(DSW_ring *ring, int count)
+{
+  DS_Weather dsw;
+  static DSW_current c;
+  static DSW_hourly  h;
+  static DSW_daily   d;
+
+  dsw.setPipeline(ring);
+
+  uint32_t full = 0, empty = 0, ok = 0;
+  bench_clock::time_point t0 = bench_clock::now();
+  for (int i = 0; i < count; i++)
+  {
+    ok += dsw.getForecast(&c, &h, &d, "key", "51.5", "-0.12", "si", "en");
+    if (ring) { full += ring->fullWaits(); empty += ring->emptyWaits(); }
+  }
+  double s = elapsed(t0);
+
+  printf("pipeline %-3s: %8.1f us/forecast, %d of %d ok", ring ? "on" : "off", s / count * 1e6, ok, count);
+  if (ring) printf(", ring %u, full waits %.1f, empty waits %.1f per forecast", ring->size(),
+                   (double)full / count, (double)empty / count);
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  static DSW_ring_t<256>  small;
+  static DSW_ring_t<4096> large;
+
+  benchRing(small, 200000000);
+  benchRing(large, 200000000);
+
+  dswHostReadCost = (argc > 1) ? atoi(argv[1]) : 20;
+  dswHostServe = serve;
+  response = httpResponse(forecastJson(1));
+  printf("forecast %u bytes, read cost %u\n", (unsigned)response.size(), dswHostReadCost);
+
+  benchForecast(nullptr, 500);
+  benchForecast(&small, 500);
+  benchForecast(&large, 500);
+
+  return 0;
+}
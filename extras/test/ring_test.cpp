@@ -0,0 +1,253 @@
+// Unit test of DSW_ring and the receive/parse pipeline on a PC, not part of the library.
+// Build from the library folder and run with:
+//
+//   g++ -std=gnu++11 -O1 -g -pthread -fsanitize=thread -DESP8266 -DDSW_STD_THREAD -Iextras/test/host -I. extras/test/ring_test.cpp extras/test/host/host.cpp DarkSkyWeather.cpp -o ring_test && ./ring_test
+//
+// Checks the ring alone (wrap around, order and integrity of patterned data across two
+// threads, backpressure, the finish()/close() handshake) and then forecasts parsed
+// through setPipeline() against the same responses parsed on one thread.
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <JSON_Decoder.h>
+
+#include "DarkSkyWeather.h"
+#include "forecast_json.h"
+
+#include <thread>
+#include <chrono>
+
+static int failures = 0;
+
+#define CHECK(x) do { if (!(x)) { failures++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static uint8_t pattern(uint32_t n) { return (uint8_t)(n * 31 + (n >> 8)); }
+
+/***************************************************************************************
+** Description:   One thread, the index arithmetic at the buffer end
+***************************************************************************************/
+static void testSingleThread()
+{
+  DSW_ring_t<256> ring;
+  uint8_t data[300];
+  for (int i = 0; i < 300; i++) data[i] = pattern(i);
+
+  CHECK(ring.size() == 256 && ring.space() == 256 && ring.available() == 0);
+  CHECK(ring.write(data, 300) == 256);   // Only what fits
+  CHECK(ring.space() == 0 && ring.write(data, 1) == 0);
+
+  const uint8_t *p;
+  CHECK(ring.peek(&p) == 256 && p[0] == pattern(0) && p[255] == pattern(255));
+  ring.consume(200);
+  CHECK(ring.space() == 200 && ring.available() == 56);
+
+  // This write wraps, peek() stops at the buffer end
+  CHECK(ring.write(data + 256, 44) == 44);
+  CHECK(ring.peek(&p) == 56 && p[0] == pattern(200));
+  ring.consume(56);
+  CHECK(ring.peek(&p) == 44 && p[0] == pattern(256) && p[43] == pattern(299));
+  ring.consume(44);
+  CHECK(ring.available() == 0 && ring.bytesWritten() == 300 && ring.peak() == 256);
+
+  ring.finish();
+  ring.close();
+  CHECK(ring.finished() && ring.closed());
+  ring.begin();
+  CHECK(!ring.finished() && !ring.closed() && ring.space() == 256 && ring.bytesWritten() == 0);
+}
+
+/***************************************************************************************
+** Description:   Two threads, odd sized writes and reads of patterned data
+***************************************************************************************/
+// The consumer sleeps now and then when slow is set, so the producer must wait for space
+static void testTwoThreads(DSW_ring &ring, uint32_t total, bool slow)
+{
+  ring.begin();
+
+  uint32_t got = 0, bad = 0;
+  std::thread consumer([&] {
+    unsigned seed = 7;
+    for (;;)
+    {
+      const uint8_t *p;
+      uint32_t n = ring.peek(&p);
+      if (n)
+      {
+        seed = seed * 1103515245 + 12345;
+        uint32_t k = 1 + (seed >> 8) % n;  // Leave some behind
+        for (uint32_t i = 0; i < k; i++) if (p[i] != pattern(got + i)) bad++;
+        got += k;
+        ring.consume(k);
+        if (slow && (seed >> 20) % 64 == 0) std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+      else
+      {
+        bool end = ring.finished();
+        if (!ring.available())
+        {
+          if (end) break;
+          ring.waitForData();
+        }
+      }
+    }
+    ring.close();
+  });
+
+  uint8_t block[1000];
+  uint32_t sent = 0, overfill = 0;
+  unsigned seed = 3;
+  while (sent < total)
+  {
+    seed = seed * 1103515245 + 12345;
+    uint32_t n = 1 + (seed >> 8) % 997;
+    if (n > total - sent) n = total - sent;
+    for (uint32_t i = 0; i < n; i++) block[i] = pattern(sent + i);
+
+    for (uint32_t w = 0; w < n; )
+    {
+      uint32_t k = ring.write(block + w, n - w);
+      if (k > n - w || ring.available() > ring.size()) overfill++;
+      if (!k) ring.waitForSpace();
+      w += k;
+    }
+    sent += n;
+  }
+
+  ring.finish();
+  while (!ring.closed()) DSW_ring::pause();
+  consumer.join();
+
+  CHECK(bad == 0);
+  CHECK(got == total);
+  CHECK(overfill == 0);
+  CHECK(ring.bytesWritten() == total);
+  CHECK(ring.peak() <= ring.size());
+  if (slow) CHECK(ring.fullWaits() > 0 && ring.peak() == ring.size());
+
+  printf("ring %u%s: %u bytes, peak %u, full waits %u, empty waits %u\n", ring.size(),
+         slow ? " slow reader" : "", got, ring.peak(), ring.fullWaits(), ring.emptyWaits());
+}
+
+/***************************************************************************************
+** Description:   The consumer stops early, as the parse task does when data is complete
+***************************************************************************************/
+static void testEarlyClose()
+{
+  DSW_ring_t<256> ring;
+  std::thread consumer([&] {
+    uint32_t got = 0;
+    while (got < 1000)
+    {
+      const uint8_t *p;
+      uint32_t n = ring.peek(&p);
+      if (n) { ring.consume(n); got += n; }
+      else ring.waitForData();
+    }
+    ring.close();
+  });
+
+  // The producer stops writing once it sees closed(), the rest is not wanted
+  uint8_t block[100] = { 0 };
+  uint32_t sent = 0;
+  while (!ring.closed() && sent < 1000000)
+  {
+    uint32_t k = ring.write(block, sizeof(block));
+    if (!k) ring.waitForSpace();
+    sent += k;
+  }
+  consumer.join();
+
+  CHECK(ring.closed());
+  CHECK(sent >= 1000 && sent < 1000000);
+}
+
+/***************************************************************************************
+** Description:   Forecasts parsed through the pipeline
+***************************************************************************************/
+static std::string response;
+static std::string serve(const std::string &) { return response; }
+
+static bool sameForecast(DSW_current *c1, DSW_hourly *h1, DSW_daily *d1,
+                         DSW_current *c2, DSW_hourly *h2, DSW_daily *d2)
+{
+  if (c1->time != c2->time || c1->temperature != c2->temperature || c1->summary != c2->summary) return false;
+  if (c1->pressure != c2->pressure || c1->windBearing != c2->windBearing) return false;
+
+  for (uint16_t i = 0; i < h1->size; i++)
+  {
+    if (h1->time[i] != h2->time[i] || h1->temperature[i] != h2->temperature[i]) return false;
+    if (h1->summary[i] != h2->summary[i] || h1->cloudCover[i] != h2->cloudCover[i]) return false;
+  }
+
+  for (uint16_t i = 0; i < d1->size; i++)
+  {
+    if (d1->time[i] != d2->time[i] || d1->temperatureHigh[i] != d2->temperatureHigh[i]) return false;
+    if (d1->summary[i] != d2->summary[i] || d1->icon[i] != d2->icon[i]) return false;
+  }
+
+  return true;
+}
+
+static void testPipeline()
+{
+  static DSW_ring_t<256> ring;
+  DS_Weather ref, dsw;
+  DSW_current rc, c;
+  DSW_hourly  rh, h;
+  DSW_daily   rd, d;
+
+  dswHostServe = serve;
+  dsw.setPipeline(&ring);
+
+  for (uint32_t version = 1; version <= 6; version++)
+  {
+    std::string body = forecastJson(version);
+    bool chunked = version & 1;
+    dswHostTrickle = (version <= 3) ? 100 : 1460;
+
+    rc.reset(); rh.reset(); rd.reset();
+    CHECK(ref.parseForecast(&rc, (DSW_minutely *)nullptr, &rh, &rd, (const uint8_t *)body.data(), body.size()));
+
+    response = httpResponse(body, chunked);
+    c.reset(); h.reset(); d.reset();
+    CHECK(dsw.getForecast(&c, &h, &d, "key", "51.5", "-0.12", "si", "en"));
+    CHECK(sameForecast(&rc, &rh, &rd, &c, &h, &d));
+    CHECK(c.time == testTime(version, 0, 0) && h.temperature[3] == testTemperature(version, 3));
+    CHECK(c.timezone == "Europe/London" && rc.timezone == c.timezone);
+    CHECK(ring.closed());
+
+    printf("pipeline %s, %u byte reads: %u bytes through the ring, peak %u, full waits %u, empty waits %u\n",
+           chunked ? "chunked" : "sized", (unsigned)dswHostTrickle, ring.bytesWritten(), ring.peak(),
+           ring.fullWaits(), ring.emptyWaits());
+  }
+
+  // A response cut short fails
+  std::string body = forecastJson(9);
+  response = httpResponse(body).substr(0, body.size() / 2);
+  CHECK(!dsw.getForecast(&c, &h, &d, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(ring.closed());
+
+  // The pipeline stops reading once the requested data is complete
+  DSW_current only;
+  response = httpResponse(forecastJson(10));
+  dswHostTrickle = 100;
+  CHECK(dsw.getForecast(&only, (DSW_hourly *)nullptr, (DSW_daily *)nullptr, "key", "51.5", "-0.12", "si", "en"));
+  CHECK(only.time == testTime(10, 0, 0));
+  CHECK(ring.bytesWritten() < response.size() / 2);
+}
+
+int main()
+{
+  static DSW_ring_t<256>  small;
+  static DSW_ring_t<4096> large;
+
+  testSingleThread();
+  testTwoThreads(small, 50000000, false);
+  testTwoThreads(large, 50000000, false);
+  testTwoThreads(small, 2000000, true);
+  testEarlyClose();
+  testPipeline();
+
+  printf("ring_test: %d failures: %s\n", failures, failures ? "FAIL" : "PASS");
+  return failures ? 1 : 0;
+}